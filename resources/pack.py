@@ -1,31 +1,138 @@
 #!/usr/bin/env python3
 
 import argparse
-from fileinput import filename
+import hashlib
 from pathlib import Path
-from sys import byteorder
+
+# Version 2 layout, all integers little endian:
+#   magic, number of entries (u64), size of the name table (u64)
+#   directory sorted by fnv1a(name), then name. Each record is 48 bytes:
+#       name hash, content hash, offset, stored size, size (u64)
+#       name offset (u32), name length (u16), flags (u16)
+#   name table
+#   payloads, each aligned to ALIGNMENT bytes from the start of the file
+PAK_MAGIC = b'BANGPAK\x02'
+ALIGNMENT = 64
+RECORD_SIZE = 48
+
+FLAG_ZSTD = 1 << 0
+FLAG_LZ4 = 1 << 1
+
+# compressed data is only kept if it is smaller than this fraction of the original
+MIN_COMPRESSION_RATIO = 0.9
 
 class FileTableItem:
-    def __init__(self, filename, name, begin, size) -> None:
+    def __init__(self, filename, name, data) -> None:
         self.filename = filename
         self.name = name
-        self.begin = begin
-        self.size = size
+        self.data = data
+
+def fnv1a_hash(data: bytes):
+    value = 0xcbf29ce484222325
+    for c in data:
+        value ^= c
+        value = (value * 0x100000001b3) & 0xffffffffffffffff
+    return value
+
+def content_hash(data: bytes):
+    return int.from_bytes(hashlib.blake2b(data, digest_size=8).digest(), byteorder='little')
+
+def get_compressor(method):
+    if method == 'zstd':
+        import zstandard
+        compressor = zstandard.ZstdCompressor(level=19)
+        return FLAG_ZSTD, compressor.compress
+    elif method == 'lz4':
+        import lz4.block
+        return FLAG_LZ4, lambda data: lz4.block.compress(data, mode='high_compression', store_size=False)
+    return 0, None
+
+def u64(value):
+    return value.to_bytes(8, byteorder='little', signed=False)
+
+def write_v1(f, items):
+    out_bytes = bytearray()
+    f.write(u64(len(items)))
+    for item in items:
+        item_name_encoded = item.name.encode()
+        f.write(u64(len(item_name_encoded)))
+        f.write(item_name_encoded)
+        f.write(u64(len(out_bytes)))
+        f.write(u64(len(item.data)))
+        out_bytes += item.data
+    f.write(out_bytes)
+
+def align(value):
+    return (value + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+def write_v2(f, items, compression):
+    flag, compress = get_compressor(compression)
+
+    entries = []
+    for item in items:
+        name = item.name.encode()
+        stored = item.data
+        flags = 0
+        if compress and len(item.data) > 0:
+            compressed = compress(item.data)
+            if len(compressed) < len(item.data) * MIN_COMPRESSION_RATIO:
+                stored = compressed
+                flags = flag
+        entries.append((fnv1a_hash(name), name, item, stored, flags))
+    entries.sort(key=lambda entry: (entry[0], entry[1]))
+
+    names = bytearray()
+    name_offsets = []
+    for _, name, _, _, _ in entries:
+        name_offsets.append(len(names))
+        names += name
+
+    offset = align(len(PAK_MAGIC) + 16 + RECORD_SIZE * len(entries) + len(names))
+    payload_offsets = []
+    for _, _, _, stored, _ in entries:
+        payload_offsets.append(offset)
+        offset = align(offset + len(stored))
+
+    f.write(PAK_MAGIC)
+    f.write(u64(len(entries)))
+    f.write(u64(len(names)))
+    for (name_hash, name, item, stored, flags), name_offset, payload_offset in zip(entries, name_offsets, payload_offsets):
+        f.write(u64(name_hash))
+        f.write(u64(content_hash(item.data)))
+        f.write(u64(payload_offset))
+        f.write(u64(len(stored)))
+        f.write(u64(len(item.data)))
+        f.write(name_offset.to_bytes(4, byteorder='little', signed=False))
+        f.write(len(name).to_bytes(2, byteorder='little', signed=False))
+        f.write(flags.to_bytes(2, byteorder='little', signed=False))
+    f.write(names)
+
+    for (_, _, _, stored, _), payload_offset in zip(entries, payload_offsets):
+        f.write(bytes(payload_offset - f.tell()))
+        f.write(stored)
 
 def main():
     parser = argparse.ArgumentParser('Pack resources')
     parser.add_argument('-q','--quiet', action='store_true', help='Quiet')
     parser.add_argument('-D','--root-path', type=Path, help='Root Path', default=Path(__file__).parent)
+    parser.add_argument('-V','--format-version', type=int, choices=[1, 2], default=2, help='Pak format version')
+    parser.add_argument('-c','--compress', choices=['none', 'zstd', 'lz4'], default='none', help='Compression (version 2 only)')
+    parser.add_argument('-r','--input-dir', type=Path, action='append', default=[], help='Add all files in directory')
     parser.add_argument('output_file', type=Path, help='Output File')
     parser.add_argument('input_files', nargs='*', type=Path, help='Input Files')
     args = parser.parse_args()
 
+    if args.format_version == 1 and args.compress != 'none':
+        parser.error('compression requires format version 2')
+
+    for input_dir in args.input_dir:
+        args.input_files += sorted(path for path in input_dir.rglob('*') if path.is_file())
+
     for path in args.input_files:
         if not path.exists():
             print(f'Invalid input file: {path}')
             exit(1)
 
-    out_bytes = bytearray()
     items = []
     for file in args.input_files:
         file = file.resolve()
@@ -39,21 +146,13 @@ def main():
             exit(1)
 
         with open(file, 'rb') as f:
-            file_bytes = bytearray(f.read())
-
-        items.append(FileTableItem(file, name, len(out_bytes), len(file_bytes)))
-
-        out_bytes += file_bytes
+            items.append(FileTableItem(file, name, f.read()))
     
     with open(args.output_file, 'wb') as f:
-        f.write(len(items).to_bytes(8, byteorder='little', signed=False))
-        for item in items:
-            item_name_encoded = item.name.encode()
-            f.write(len(item_name_encoded).to_bytes(8, byteorder='little', signed=False))
-            f.write(item_name_encoded)
-            f.write(item.begin.to_bytes(8, byteorder='little', signed=False))
-            f.write(item.size.to_bytes(8, byteorder='little', signed=False))
-        f.write(out_bytes)
+        if args.format_version == 1:
+            write_v1(f, items)
+        else:
+            write_v2(f, items, args.compress)
 
 if __name__ == '__main__':
-    main()
\ No newline at end of file
+    main()
@@ -0,0 +1,110 @@
+#include "alpha_mask.h"
+
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define ALPHA_MASK_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define TARGET_AVX2
+    #else
+        #define TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+    #define ALPHA_MASK_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace sdl {
+
+    static void copy_alpha_scalar(uint32_t *dest, const uint32_t *mask, size_t count, uint32_t alpha) {
+        for (size_t i = 0; i < count; ++i) {
+            dest[i] = (dest[i] & ~alpha) | (mask[i] & alpha);
+        }
+    }
+
+#ifdef ALPHA_MASK_X86
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ALPHA_MASK_SSE2
+    static void copy_alpha_sse2(uint32_t *dest, const uint32_t *mask, size_t count, uint32_t alpha) {
+        const __m128i alpha_vec = _mm_set1_epi32(int(alpha));
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dest + i));
+            __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + i));
+            d = _mm_or_si128(_mm_andnot_si128(alpha_vec, d), _mm_and_si128(alpha_vec, m));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), d);
+        }
+        copy_alpha_scalar(dest + i, mask + i, count - i, alpha);
+    }
+#endif
+
+    TARGET_AVX2 static void copy_alpha_avx2(uint32_t *dest, const uint32_t *mask, size_t count, uint32_t alpha) {
+        const __m256i alpha_vec = _mm256_set1_epi32(int(alpha));
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dest + i));
+            __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask + i));
+            d = _mm256_or_si256(_mm256_andnot_si256(alpha_vec, d), _mm256_and_si256(alpha_vec, m));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + i), d);
+        }
+        copy_alpha_scalar(dest + i, mask + i, count - i, alpha);
+    }
+
+    static bool cpu_has_avx2() {
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        // the os must also save the ymm registers
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        return __builtin_cpu_supports("avx2");
+    #endif
+    }
+#endif
+
+#ifdef ALPHA_MASK_NEON
+    static void copy_alpha_neon(uint32_t *dest, const uint32_t *mask, size_t count, uint32_t alpha) {
+        const uint32x4_t alpha_vec = vdupq_n_u32(alpha);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            vst1q_u32(dest + i, vbslq_u32(alpha_vec, vld1q_u32(mask + i), vld1q_u32(dest + i)));
+        }
+        copy_alpha_scalar(dest + i, mask + i, count - i, alpha);
+    }
+#endif
+
+    static std::vector<copy_alpha_kernel> make_copy_alpha_kernels() {
+        std::vector<copy_alpha_kernel> ret;
+        ret.push_back({"scalar", copy_alpha_scalar});
+#ifdef ALPHA_MASK_SSE2
+        ret.push_back({"sse2", copy_alpha_sse2});
+#endif
+#ifdef ALPHA_MASK_X86
+        if (cpu_has_avx2()) {
+            ret.push_back({"avx2", copy_alpha_avx2});
+        }
+#endif
+#ifdef ALPHA_MASK_NEON
+        ret.push_back({"neon", copy_alpha_neon});
+#endif
+        return ret;
+    }
+
+    std::span<const copy_alpha_kernel> get_copy_alpha_kernels() {
+        static const std::vector<copy_alpha_kernel> kernels = make_copy_alpha_kernels();
+        return kernels;
+    }
+
+    void copy_alpha_row(uint32_t *dest, const uint32_t *mask, size_t count, uint32_t alpha) {
+        static const copy_alpha_function function = get_copy_alpha_kernels().back().function;
+        function(dest, mask, count, alpha);
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef __ALPHA_MASK_H__
+#define __ALPHA_MASK_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace sdl {
+
+    // for each pixel: dest = (dest & ~alpha) | (mask & alpha)
+    using copy_alpha_function = void (*)(uint32_t *dest, const uint32_t *mask, size_t count, uint32_t alpha);
+
+    struct copy_alpha_kernel {
+        std::string_view name;
+        copy_alpha_function function;
+    };
+
+    // the kernels this cpu can run, from the scalar one to the one picked by copy_alpha_row
+    std::span<const copy_alpha_kernel> get_copy_alpha_kernels();
+
+    void copy_alpha_row(uint32_t *dest, const uint32_t *mask, size_t count, uint32_t alpha);
+
+}
+
+#endif
\ No newline at end of file
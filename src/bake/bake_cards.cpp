@@ -0,0 +1,54 @@
+#include "pak_file.h"
+#include "baked_image.h"
+#include "gamescene/options.h"
+
+#include <fstream>
+
+// Decodes every card image in cards.pak ahead of time, with misc/card_mask already applied,
+// along with the variant shrunk to the card width, so that the client can upload them
+// without decoding or masking anything. The output directory is then packed with pack.py
+
+static void write_image(std::filesystem::path path, const sdl::surface &image) {
+    path += ".rgba";
+    std::filesystem::create_directories(path.parent_path());
+
+    std::ofstream stream(path, std::ios::out | std::ios::binary);
+    sdl::save_baked_image(stream, image);
+    if (stream.fail()) {
+        throw std::runtime_error(fmt::format("Could not write {}", path.string()));
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fmt::print(stderr, "Usage: {} <cards.pak> <output directory>\n", argv[0]);
+        return 1;
+    }
+
+    try {
+        sdl::img_initializer sdl_img_init{IMG_INIT_PNG | IMG_INIT_JPG};
+
+        pak_file cards{argv[1]};
+        std::filesystem::path output_dir{argv[2]};
+        std::filesystem::remove_all(output_dir);
+
+        sdl::surface card_mask(cards["misc/card_mask"]);
+
+        for (std::string_view name : cards.names()) {
+            if (name.starts_with("misc/")) continue;
+
+            sdl::surface masked = sdl::apply_alpha_mask(sdl::surface(cards[name]), card_mask);
+
+            // same as scale_to_card_width in gamescene/card.cpp
+            sdl::rect scaled_rect = sdl::shrink_rect_to_width(masked.get_rect(), banggame::options.card_width);
+
+            write_image(output_dir / "full" / name, masked);
+            write_image(output_dir / "scaled" / name, sdl::scale_surface(masked, scaled_rect.w, scaled_rect.h));
+        }
+    } catch (const std::exception &error) {
+        fmt::print(stderr, "Error: {}\n", error.what());
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef __BAKED_IMAGE_H__
+#define __BAKED_IMAGE_H__
+
+#include "sdl_wrap.h"
+
+#include <cstring>
+#include <ostream>
+#include <string_view>
+
+namespace sdl {
+
+    // Images pre-decoded by bangbake: a 16 byte header with baked_image_magic, then width, height
+    // and a reserved field as u32 little endian, followed by the RGBA32 pixels without row padding
+    inline constexpr std::string_view baked_image_magic{"RGBA", 4};
+    inline constexpr size_t baked_image_header_size = 16;
+
+    namespace detail {
+        inline uint32_t read_u32(const char *bytes) {
+            uint32_t value = 0;
+            for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+                value |= uint32_t(static_cast<uint8_t>(bytes[i])) << (i * 8);
+            }
+            return value;
+        }
+
+        inline void write_u32(std::ostream &stream, uint32_t value) {
+            for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+                stream.put(char((value >> (i * 8)) & 0xff));
+            }
+        }
+    }
+
+    // the pixels are copied, res can be freed once this returns
+    inline surface load_baked_image(resource_view res) {
+        if (res.length < baked_image_header_size || std::string_view(res.data, baked_image_magic.size()) != baked_image_magic) {
+            throw error("Invalid baked image");
+        }
+        uint32_t width = detail::read_u32(res.data + 4);
+        uint32_t height = detail::read_u32(res.data + 8);
+        if (width > 0xffff || height > 0xffff || res.length - baked_image_header_size != size_t(width) * height * 4) {
+            throw error("Invalid baked image");
+        }
+        surface ret = SDL_CreateRGBSurfaceWithFormat(0, int(width), int(height), 32, SDL_PIXELFORMAT_RGBA32);
+        if (!ret) throw error(fmt::format("Could not create surface: {}", SDL_GetError()));
+
+        const char *pixels = res.data + baked_image_header_size;
+        for (uint32_t y = 0; y < height; ++y) {
+            std::memcpy(static_cast<char *>(ret.get()->pixels) + y * ret.get()->pitch, pixels + y * width * 4, width * 4);
+        }
+        return ret;
+    }
+
+    inline void save_baked_image(std::ostream &stream, const surface &image) {
+        surface converted = SDL_ConvertSurfaceFormat(image.get(), SDL_PIXELFORMAT_RGBA32, 0);
+        if (!converted) throw error(fmt::format("Could not convert surface: {}", SDL_GetError()));
+
+        SDL_Surface *surf = converted.get();
+        stream.write(baked_image_magic.data(), baked_image_magic.size());
+        detail::write_u32(stream, uint32_t(surf->w));
+        detail::write_u32(stream, uint32_t(surf->h));
+        detail::write_u32(stream, 0);
+
+        SDL_LockSurface(surf);
+        for (int y = 0; y < surf->h; ++y) {
+            stream.write(static_cast<const char *>(surf->pixels) + y * surf->pitch, surf->w * 4);
+        }
+        SDL_UnlockSurface(surf);
+    }
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "bench.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef ENABLE_ALLOC_COUNTER
+
+static std::atomic<size_t> s_allocation_count = 0;
+
+void *operator new(size_t size) {
+    s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace bench {
+    size_t allocation_count() {
+        return s_allocation_count.load(std::memory_order_relaxed);
+    }
+
+    bool allocation_counter_enabled() {
+        return true;
+    }
+}
+
+#else
+
+namespace bench {
+    size_t allocation_count() {
+        return 0;
+    }
+
+    bool allocation_counter_enabled() {
+        return false;
+    }
+}
+
+#endif
\ No newline at end of file
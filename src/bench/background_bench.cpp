@@ -0,0 +1,60 @@
+#include "bench.h"
+
+#include "../manager.h"
+
+namespace bench {
+
+    using clock = std::chrono::steady_clock;
+
+    // number of copies issued by the loop bounds render_tiled used to have,
+    // which iterated on dst_rect.w + dst_rect.h and one tile past the right edge
+    static int old_tiled_copy_count(const sdl::rect &src_rect, const sdl::rect &dst_rect) {
+        int rows = (dst_rect.w + dst_rect.h + src_rect.h - dst_rect.y) / src_rect.h + 1;
+        int cols = (dst_rect.w + src_rect.w) / src_rect.w + 1;
+        return rows * cols;
+    }
+
+    int background_benchmark(const std::filesystem::path &base_path, bench_args args) {
+        const int width = args.size() > 0 ? std::stoi(args[0]) : 3840;
+        const int height = args.size() > 1 ? std::stoi(args[1]) : 2160;
+        const int num_frames = args.size() > 2 ? std::stoi(args[2]) : 100;
+
+        headless_context context{base_path, width, height};
+        const sdl::rect win_rect{0, 0, width, height};
+        sdl::texture_ref tile = media_pak::get().texture_background;
+
+        sample_timer tiled_times;
+        int tiled_copies = 0;
+        for (int i=0; i<num_frames; ++i) {
+            auto frame_begin = clock::now();
+            tiled_copies = sdl::render_tiled(context.renderer, tile, win_rect);
+            SDL_RenderFlush(context.renderer.get());
+            tiled_times.add(clock::now() - frame_begin);
+        }
+
+        auto compose_begin = clock::now();
+        sdl::texture background = make_background_texture(context.renderer, tile, win_rect);
+        const duration_type compose_time = clock::now() - compose_begin;
+        if (!background) {
+            fmt::print(stderr, "Render targets are not supported\n");
+            return 1;
+        }
+
+        sample_timer cached_times;
+        for (int i=0; i<num_frames; ++i) {
+            auto frame_begin = clock::now();
+            background.render(context.renderer, win_rect);
+            SDL_RenderFlush(context.renderer.get());
+            cached_times.add(clock::now() - frame_begin);
+        }
+
+        fmt::print("window size:          {}x{}, tile {}x{}\n", width, height, tile.get_rect().w, tile.get_rect().h);
+        fmt::print("copies/frame before:  {} (old loop bounds), {} (fixed)\n", old_tiled_copy_count(tile.get_rect(), win_rect), tiled_copies);
+        fmt::print("copies/frame after:   1 (+{} once per resize, {:.3f} ms)\n", tiled_copies, to_millis(compose_time));
+        fmt::print("tiled p50/p99:        {:.3f} / {:.3f} ms\n", to_millis(tiled_times.percentile(.5)), to_millis(tiled_times.percentile(.99)));
+        fmt::print("cached p50/p99:       {:.3f} / {:.3f} ms\n", to_millis(cached_times.percentile(.5)), to_millis(cached_times.percentile(.99)));
+
+        return 0;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "bench.h"
+
+namespace bench {
+
+    struct bench_case {
+        std::string_view name;
+        std::string_view usage;
+        int (*function)(const std::filesystem::path &base_path, bench_args args);
+    };
+
+    static constexpr bench_case bench_cases[] = {
+        {"replay", "<session log> [tick ms]", replay_benchmark},
+        {"background", "[width] [height] [frames]", background_benchmark},
+        {"mask", "[iterations]", mask_benchmark},
+        {"scale", "[iterations]", scale_benchmark},
+        {"chat", "[messages] [frames]", chat_benchmark},
+        {"sounds", "[other sounds.pak...]", sounds_benchmark},
+        {"startup", "[runs]", startup_benchmark},
+    };
+
+    static void print_usage() {
+        fmt::print(stderr, "Available benchmarks:\n");
+        for (const auto &value : bench_cases) {
+            fmt::print(stderr, "    bangbench {} {}\n", value.name, value.usage);
+        }
+    }
+
+}
+
+// the paks are looked up next to the executable, as the launcher does
+int main(int argc, char **argv) {
+    bench::bench_args args{argv + 1, size_t(argc - 1)};
+    if (args.empty()) {
+        bench::print_usage();
+        return 1;
+    }
+
+    std::filesystem::path base_path;
+    if (char *path = SDL_GetBasePath()) {
+        base_path = path;
+        SDL_free(path);
+    }
+
+    try {
+        for (const auto &value : bench::bench_cases) {
+            if (value.name == args.front()) {
+                return value.function(base_path, args.subspan(1));
+            }
+        }
+        bench::print_usage();
+        return 1;
+    } catch (const std::exception &error) {
+        fmt::print(stderr, "Uncaught exception: {}\n", error.what());
+        return 1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include "sdl_wrap.h"
+#include "widgets/defaults.h"
+#include "media_pak.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+#include <span>
+#include <vector>
+
+namespace bench {
+
+    using bench_args = std::span<const char * const>;
+
+    int replay_benchmark(const std::filesystem::path &base_path, bench_args args);
+    int background_benchmark(const std::filesystem::path &base_path, bench_args args);
+    int mask_benchmark(const std::filesystem::path &base_path, bench_args args);
+    int scale_benchmark(const std::filesystem::path &base_path, bench_args args);
+    int chat_benchmark(const std::filesystem::path &base_path, bench_args args);
+    int sounds_benchmark(const std::filesystem::path &base_path, bench_args args);
+    int startup_benchmark(const std::filesystem::path &base_path, bench_args args);
+
+    size_t allocation_count();
+    bool allocation_counter_enabled();
+
+    inline double to_millis(duration_type duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    class sample_timer {
+    public:
+        void add(duration_type sample) {
+            m_samples.push_back(sample);
+            m_total += sample;
+        }
+
+        size_t size() const {
+            return m_samples.size();
+        }
+
+        duration_type total() const {
+            return m_total;
+        }
+
+        duration_type percentile(double amt) {
+            if (m_samples.empty()) {
+                return duration_type{0};
+            }
+            auto it = m_samples.begin() + std::min(m_samples.size() - 1, size_t(amt * m_samples.size()));
+            std::nth_element(m_samples.begin(), it, m_samples.end());
+            return *it;
+        }
+
+    private:
+        std::vector<duration_type> m_samples;
+        duration_type m_total{0};
+    };
+
+    struct headless_hints {
+        headless_hints() {
+            SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+            SDL_SetHint(SDL_HINT_AUDIODRIVER, "dummy");
+            // the dummy video driver has no accelerated renderer, the hint overrides the renderer flags
+            SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+        }
+    };
+
+    struct headless_context {
+        headless_hints hints;
+
+        sdl::initializer sdl_init{SDL_INIT_VIDEO | SDL_INIT_AUDIO};
+        sdl::ttf_initializer sdl_ttf_init;
+        sdl::img_initializer sdl_img_init{IMG_INIT_PNG | IMG_INIT_JPG};
+
+        sdl::window window;
+        sdl::renderer renderer;
+
+        media_pak resources;
+
+        headless_context(const std::filesystem::path &base_path, int width = 900, int height = 700)
+            : window("bench", 0, 0, width, height, 0)
+            , renderer(window, -1, SDL_RENDERER_SOFTWARE)
+            , resources(base_path, renderer) {}
+    };
+
+}
+
+#endif
\ No newline at end of file
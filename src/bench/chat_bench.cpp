@@ -0,0 +1,56 @@
+#include "bench.h"
+
+#include "../chat_ui.h"
+#include "../widgets/font_cache.h"
+
+namespace bench {
+
+    using clock = std::chrono::steady_clock;
+
+    int chat_benchmark(const std::filesystem::path &base_path, bench_args args) {
+        const int num_messages = args.size() > 0 ? std::stoi(args[0]) : 100;
+        const int num_frames = args.size() > 1 ? std::stoi(args[1]) : 100;
+
+        headless_context context{base_path};
+
+        const size_t allocations_begin = allocation_count();
+        auto construct_begin = clock::now();
+
+        // tall enough to keep every message, which is rendered as it arrives like in the client
+        chat_ui chat{nullptr};
+        chat.set_rect(sdl::rect{10, 10, 400, num_messages * 40 + 35});
+        for (int i=0; i<num_messages; ++i) {
+            chat.add_message(i % 10 == 0 ? message_type::server_log : message_type::chat,
+                fmt::format("player{}: message number {} sent to the chat benchmark", i % 8, i));
+            chat.render(context.renderer);
+        }
+        SDL_RenderFlush(context.renderer.get());
+
+        const duration_type construct_time = clock::now() - construct_begin;
+        const size_t allocations = allocation_count() - allocations_begin;
+
+        sample_timer frame_times;
+        for (int i=0; i<num_frames; ++i) {
+            auto frame_begin = clock::now();
+            chat.render(context.renderer);
+            SDL_RenderFlush(context.renderer.get());
+            frame_times.add(clock::now() - frame_begin);
+        }
+
+        const auto stats = widgets::font_cache::get_stats();
+
+        fmt::print("messages:         {}\n", num_messages);
+        fmt::print("construction:     {:.3f} ms ({:.4f} ms/message)\n", to_millis(construct_time), to_millis(construct_time) / std::max(1, num_messages));
+        fmt::print("frame p50/p99:    {:.3f} / {:.3f} ms\n", to_millis(frame_times.percentile(.5)), to_millis(frame_times.percentile(.99)));
+        fmt::print("fonts:            {} opened, {} open for {} widgets\n", stats.fonts_opened, stats.fonts_open, stats.lookups);
+        fmt::print("glyph atlases:    {:.1f} KiB\n", stats.atlas_bytes / 1024.0);
+        if (allocation_counter_enabled()) {
+            fmt::print("allocs/message:   {:.1f}\n", double(allocations) / std::max(1, num_messages));
+        } else {
+            fmt::print("allocs/message:   n/a (configure with -DENABLE_ALLOC_COUNTER=ON)\n");
+        }
+
+        return 0;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "bench.h"
+
+#include "../pak_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bench {
+
+    using clock = std::chrono::steady_clock;
+
+    // same row walk as sdl::copy_alpha_channel, with the kernel given explicitly
+    static void copy_alpha_surface(sdl::copy_alpha_function function, SDL_Surface *dest, SDL_Surface *mask, int width) {
+        const uint32_t alpha = mask->format->Amask;
+        for (int y = 0; y < dest->h; ++y) {
+            function(
+                reinterpret_cast<uint32_t *>(static_cast<uint8_t *>(dest->pixels) + y * dest->pitch),
+                reinterpret_cast<const uint32_t *>(static_cast<const uint8_t *>(mask->pixels) + y * mask->pitch),
+                size_t(width), alpha);
+        }
+    }
+
+    static bool same_pixels(SDL_Surface *lhs, SDL_Surface *rhs) {
+        for (int y = 0; y < lhs->h; ++y) {
+            if (std::memcmp(static_cast<const uint8_t *>(lhs->pixels) + y * lhs->pitch,
+                static_cast<const uint8_t *>(rhs->pixels) + y * rhs->pitch, lhs->w * 4) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // compares the kernel with the scalar one on short rows and on all the remainders of the vector widths,
+    // the whole surface is compared so that writes past the end of the row are caught too
+    static bool check_kernel(sdl::copy_alpha_function function, SDL_Surface *source, SDL_Surface *mask) {
+        const auto scalar = sdl::get_copy_alpha_kernels().front().function;
+
+        std::vector<int> widths;
+        for (int width = 1; width <= 17 && width <= source->w; ++width) {
+            widths.push_back(width);
+        }
+        for (int width = std::max(18, source->w - 16); width <= source->w; ++width) {
+            widths.push_back(width);
+        }
+
+        for (int width : widths) {
+            sdl::surface dest = SDL_DuplicateSurface(source);
+            sdl::surface expected = SDL_DuplicateSurface(source);
+            copy_alpha_surface(scalar, expected.get(), mask, width);
+            copy_alpha_surface(function, dest.get(), mask, width);
+            if (!same_pixels(dest.get(), expected.get())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int mask_benchmark(const std::filesystem::path &base_path, bench_args args) {
+        const int iterations = args.size() > 0 ? std::stoi(args[0]) : 1000;
+
+        sdl::img_initializer sdl_img_init{IMG_INIT_PNG | IMG_INIT_JPG};
+
+        pak_file cards{base_path / "cards.pak"};
+        sdl::surface card_mask(cards["misc/card_mask"]);
+
+        auto names = cards.names();
+        auto it = std::ranges::find_if(names, [](std::string_view name) { return !name.starts_with("misc/"); });
+        if (it == names.end()) {
+            fmt::print(stderr, "No card images in cards.pak\n");
+            return 1;
+        }
+
+        // the blit is done once, only the alpha merge is timed.
+        // The alpha of the source is the complement of the mask, so that every pixel has to change
+        sdl::surface source(card_mask.get()->w, card_mask.get()->h);
+        SDL_BlitSurface(sdl::surface(cards[*it]).get(), nullptr, source.get(), nullptr);
+        const uint32_t alpha = card_mask.get()->format->Amask;
+        for (int y = 0; y < source.get()->h; ++y) {
+            auto *row = reinterpret_cast<uint32_t *>(static_cast<uint8_t *>(source.get()->pixels) + y * source.get()->pitch);
+            const auto *mask_row = reinterpret_cast<const uint32_t *>(static_cast<const uint8_t *>(card_mask.get()->pixels) + y * card_mask.get()->pitch);
+            for (int x = 0; x < source.get()->w; ++x) {
+                row[x] = (row[x] & ~alpha) | (~mask_row[x] & alpha);
+            }
+        }
+        const size_t num_pixels = size_t(source.get()->w) * source.get()->h;
+
+        fmt::print("image:      {} ({}x{})\n", *it, source.get()->w, source.get()->h);
+        fmt::print("iterations: {}\n", iterations);
+
+        double scalar_time = 0.0;
+        for (const sdl::copy_alpha_kernel &kernel : sdl::get_copy_alpha_kernels()) {
+            sdl::surface dest = SDL_DuplicateSurface(source.get());
+
+            sample_timer times;
+            for (int i=0; i<iterations; ++i) {
+                auto begin = clock::now();
+                copy_alpha_surface(kernel.function, dest.get(), card_mask.get(), dest.get()->w);
+                times.add(clock::now() - begin);
+            }
+
+            double p50 = to_millis(times.percentile(.5));
+            if (scalar_time == 0.0) {
+                scalar_time = p50;
+            }
+
+            fmt::print("{:<8} p50 {:.4f} ms, {:.0f} Mpixel/s, {:.2f}x{}\n", kernel.name, p50,
+                num_pixels / (p50 * 1000.0), scalar_time / p50,
+                check_kernel(kernel.function, source.get(), card_mask.get()) ? "" : " (MISMATCH)");
+        }
+        fmt::print("selected: {}\n", sdl::get_copy_alpha_kernels().back().name);
+
+        return 0;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "bench.h"
+
+#include "../manager.h"
+#include "../session_log.h"
+#include "../gamescene/game.h"
+
+namespace bench {
+
+    using clock = std::chrono::steady_clock;
+
+    class replay_client : public client_manager {
+    public:
+        using client_manager::client_manager;
+        using client_manager::on_message;
+
+        bool has_pending_updates() const {
+            auto *scene = dynamic_cast<banggame::game_scene *>(get_scene());
+            return scene && scene->has_pending_updates();
+        }
+    };
+
+    int replay_benchmark(const std::filesystem::path &base_path, bench_args args) {
+        if (args.empty()) {
+            fmt::print(stderr, "Missing session log\n");
+            return 1;
+        }
+
+        std::vector<std::string> messages;
+        session_reader reader{args[0]};
+        while (auto record = reader.read_next()) {
+            messages.push_back(std::move(record->message));
+        }
+
+        const duration_type tick_duration = std::chrono::milliseconds{args.size() > 1 ? std::stoi(args[1]) : 16};
+
+        headless_context context{base_path};
+        replay_client mgr{context.window, context.renderer, base_path, config{}, false};
+        mgr.switch_scene<banggame::game_scene>();
+
+        sample_timer message_times;
+        sample_timer tick_times;
+
+        const size_t allocations_begin = allocation_count();
+
+        for (const std::string &message : messages) {
+            auto message_begin = clock::now();
+            mgr.on_message(message);
+            message_times.add(clock::now() - message_begin);
+
+            do {
+                auto tick_begin = clock::now();
+                mgr.tick(tick_duration);
+                tick_times.add(clock::now() - tick_begin);
+            } while (mgr.has_pending_updates());
+        }
+
+        const size_t allocations = allocation_count() - allocations_begin;
+        const duration_type total_time = message_times.total() + tick_times.total();
+
+        fmt::print("messages:         {}\n", messages.size());
+        fmt::print("ticks:            {}\n", tick_times.size());
+        fmt::print("total time:       {:.3f} ms\n", to_millis(total_time));
+        fmt::print("updates/sec:      {:.1f}\n", messages.size() / std::chrono::duration<double>(total_time).count());
+        fmt::print("message p50/p99:  {:.3f} / {:.3f} ms\n", to_millis(message_times.percentile(.5)), to_millis(message_times.percentile(.99)));
+        fmt::print("tick p50/p99:     {:.3f} / {:.3f} ms\n", to_millis(tick_times.percentile(.5)), to_millis(tick_times.percentile(.99)));
+        const auto &face_stats = banggame::card_textures::get().get_face_stats();
+        fmt::print("face cache:       {} hits, {} misses ({:.1f}% hit rate), {} evictions\n",
+            face_stats.hits, face_stats.misses, face_stats.hit_rate() * 100.0, face_stats.evictions);
+        const auto overlay_stats = banggame::card_textures::get().get_overlay_stats();
+        fmt::print("overlay textures: {} created, {:.1f} MiB resident, {:.1f} MiB saved\n",
+            overlay_stats.created, overlay_stats.resident_bytes / 1048576.0, overlay_stats.saved_bytes / 1048576.0);
+        if (allocation_counter_enabled()) {
+            fmt::print("allocs/update:    {:.1f}\n", double(allocations) / std::max(size_t(1), messages.size()));
+        } else {
+            fmt::print("allocs/update:    n/a (configure with -DENABLE_ALLOC_COUNTER=ON)\n");
+        }
+
+        return 0;
+    }
+
+}
\ No newline at end of file
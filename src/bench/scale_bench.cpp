@@ -0,0 +1,63 @@
+#include "bench.h"
+
+#include "../pak_file.h"
+#include "../gamescene/options.h"
+
+#include <algorithm>
+
+namespace bench {
+
+    using clock = std::chrono::steady_clock;
+
+    template<typename Function>
+    static duration_type time_scale(int iterations, Function &&function) {
+        sample_timer times;
+        for (int i=0; i<iterations; ++i) {
+            auto begin = clock::now();
+            sdl::surface result = function();
+            times.add(clock::now() - begin);
+        }
+        return times.percentile(.5);
+    }
+
+    int scale_benchmark(const std::filesystem::path &base_path, bench_args args) {
+        const int iterations = args.size() > 0 ? std::stoi(args[0]) : 200;
+
+        sdl::img_initializer sdl_img_init{IMG_INIT_PNG | IMG_INIT_JPG};
+
+        pak_file cards{base_path / "cards.pak"};
+        sdl::surface card_mask(cards["misc/card_mask"]);
+
+        auto names = cards.names();
+        auto it = std::ranges::find_if(names, [](std::string_view name) { return !name.starts_with("misc/"); });
+        if (it == names.end()) {
+            fmt::print(stderr, "No card images in cards.pak\n");
+            return 1;
+        }
+
+        sdl::surface source = sdl::apply_alpha_mask(sdl::surface(cards[*it]), card_mask);
+        const sdl::rect src_rect = source.get_rect();
+        const int factor = std::max(1, src_rect.w / banggame::options.card_width);
+        const sdl::rect exact_rect = sdl::shrink_rect_to_width(src_rect, banggame::options.card_width);
+
+        duration_type gfx_time = time_scale(iterations, [&]{
+            return sdl::surface(shrinkSurface(source.get(), factor, factor));
+        });
+        duration_type area_time = time_scale(iterations, [&]{
+            return sdl::scale_surface(source, factor);
+        });
+        duration_type exact_time = time_scale(iterations, [&]{
+            return sdl::scale_surface(source, exact_rect.w, exact_rect.h);
+        });
+
+        fmt::print("image:                {} ({}x{})\n", *it, src_rect.w, src_rect.h);
+        fmt::print("shrinkSurface /{}:     {}x{}, p50 {:.4f} ms\n", factor, src_rect.w / factor, src_rect.h / factor, to_millis(gfx_time));
+        fmt::print("area scale /{}:        {}x{}, p50 {:.4f} ms ({:.2f}x)\n", factor, src_rect.w / factor, src_rect.h / factor,
+            to_millis(area_time), to_millis(gfx_time) / to_millis(area_time));
+        fmt::print("area scale to width:  {}x{}, p50 {:.4f} ms ({:.2f}x)\n", exact_rect.w, exact_rect.h,
+            to_millis(exact_time), to_millis(gfx_time) / to_millis(exact_time));
+
+        return 0;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "bench.h"
+
+#include "../sounds_pak.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace bench {
+
+    using clock = std::chrono::steady_clock;
+
+    // resident set size read from /proc, zero where it's not available
+    static size_t resident_bytes() {
+        std::ifstream stream{"/proc/self/status"};
+        std::string key;
+        while (stream >> key) {
+            if (key == "VmRSS:") {
+                size_t kib = 0;
+                stream >> kib;
+                return kib * 1024;
+            }
+            stream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+        return 0;
+    }
+
+    // decodes every sound of each pak with sdl::wav_file, as the loader thread of sounds_pak does.
+    // Build a second sounds.pak with the other SOUND_CODEC and pass it to compare the two formats
+    static void bench_sounds_pak(const std::filesystem::path &path) {
+        pak_file pak{path};
+
+        size_t num_ogg = 0;
+        size_t stored_bytes = 0;
+        size_t pcm_bytes = 0;
+        size_t largest_pcm_bytes = 0;
+        sample_timer load_times;
+
+        // the chunks are kept as the client does, to measure what the decoded bank keeps resident
+        std::vector<sdl::wav_file> chunks;
+        const size_t resident_begin = resident_bytes();
+
+        for (std::string_view name : pak.names()) {
+            resource_view res = pak[name];
+            stored_bytes += res.length;
+            if (res.length >= 4 && std::memcmp(res.data, "OggS", 4) == 0) {
+                ++num_ogg;
+            }
+
+            auto load_begin = clock::now();
+            sdl::wav_file chunk{res};
+            load_times.add(clock::now() - load_begin);
+
+            pcm_bytes += chunk->alen;
+            largest_pcm_bytes = std::max(largest_pcm_bytes, size_t(chunk->alen));
+            chunks.push_back(std::move(chunk));
+        }
+
+        const size_t resident_end = resident_bytes();
+
+        const size_t num_sounds = load_times.size();
+        fmt::print("{}:\n", path.string());
+        fmt::print("    sounds:               {} ({} ogg)\n", num_sounds, num_ogg);
+        fmt::print("    pak size:             {:.1f} KiB ({:.1f} KiB of sounds)\n",
+            std::filesystem::file_size(path) / 1024.0, stored_bytes / 1024.0);
+        fmt::print("    decoded pcm:          {:.1f} KiB, largest sound {:.1f} KiB\n", pcm_bytes / 1024.0, largest_pcm_bytes / 1024.0);
+        if (resident_begin != 0) {
+            fmt::print("    resident growth:      {:.1f} KiB\n", (double(resident_end) - double(resident_begin)) / 1024.0);
+        } else {
+            fmt::print("    resident growth:      n/a\n");
+        }
+        // a sound only plays once it's decoded whole, this is also the time to its first sample
+        fmt::print("    full decode time:     p50 {:.3f} ms, max {:.3f} ms\n",
+            to_millis(load_times.percentile(.5)), to_millis(load_times.percentile(1.0)));
+        fmt::print("    whole bank:           {:.3f} ms\n", to_millis(load_times.total()));
+    }
+
+    int sounds_benchmark(const std::filesystem::path &base_path, bench_args args) {
+        headless_hints hints;
+        sdl::initializer sdl_init{SDL_INIT_AUDIO};
+
+        sdl::mixer_initializer mixer;
+
+        bench_sounds_pak(base_path / "sounds.pak");
+        for (const char *path : args) {
+            bench_sounds_pak(path);
+        }
+
+        return 0;
+    }
+
+}
\ No newline at end of file
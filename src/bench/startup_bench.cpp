@@ -0,0 +1,44 @@
+#include "bench.h"
+
+#include "../entrypoint.h"
+#include "../startup_trace.h"
+
+#include <map>
+
+namespace bench {
+
+    using clock = std::chrono::steady_clock;
+
+    int startup_benchmark(const std::filesystem::path &base_path, bench_args args) {
+        const int runs = args.empty() ? 5 : std::stoi(args[0]);
+
+        headless_hints hints;
+
+        sample_timer run_times;
+        std::map<std::string_view, sample_timer> span_times;
+
+        for (int i = 0; i < runs; ++i) {
+            auto run_begin = clock::now();
+            if (long result = run_client_first_frame(base_path.string().c_str())) {
+                return int(result);
+            }
+            const duration_type run_time = clock::now() - run_begin;
+            run_times.add(run_time);
+
+            // the first run is the only one with cold file caches
+            fmt::print("run {:<2} {:8.2f} ms{}\n", i + 1, to_millis(run_time), i == 0 ? " (cold)" : "");
+
+            for (const auto &record : startup_trace::get_spans()) {
+                span_times[record.name].add(record.end - record.begin);
+            }
+        }
+
+        fmt::print("\nfirst frame p50: {:.2f} ms\n", to_millis(run_times.percentile(.5)));
+        for (auto &[name, times] : span_times) {
+            fmt::print("{:<24} p50 {:8.2f} ms, max {:8.2f} ms\n", name, to_millis(times.percentile(.5)), to_millis(times.percentile(1.0)));
+        }
+
+        return 0;
+    }
+
+}
\ No newline at end of file
@@ -34,6 +34,7 @@ void chat_ui::tick(duration_type time_elapsed) {
     for (auto it = m_messages.rbegin(); it != m_messages.rend(); ++it) {
         if (it->lifetime <= time_elapsed) {
             m_messages.erase(m_messages.begin(), it.base());
+            parent->invalidate();
             break;
         }
         it->lifetime -= time_elapsed;
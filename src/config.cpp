@@ -1,5 +1,7 @@
 #include "config.h"
 
+#include "startup_trace.h"
+
 static const std::filesystem::path filename = std::filesystem::path(SDL_GetPrefPath(nullptr, "bang-sdl")) / "config.json";
 
 void config::load() {
@@ -22,4 +24,11 @@ void config::load() {
 void config::save()  {
     std::ofstream ofs{filename};
     ofs << std::setw(2) << json::serialize(*this);
+}
+
+config load_config() {
+    startup_trace::span span{"config load"};
+    config ret;
+    ret.load();
+    return ret;
 }
\ No newline at end of file
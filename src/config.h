@@ -25,10 +25,15 @@ DEFINE_STRUCT(config,
     (uint16_t, server_port)
     (bool, server_enable_cheats)
     (bool, server_verbose)
+    (bool, record_sessions)
+    (bool, network_thread)
     (int, user_id),
     
     void load();
     void save();
 )
 
+// the saved config, or the defaults if there is none
+config load_config();
+
 #endif
\ No newline at end of file
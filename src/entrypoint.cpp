@@ -4,9 +4,15 @@
 
 #include "manager.h"
 #include "media_pak.h"
+#include "session_log.h"
+#include "startup_trace.h"
+#include "entrypoint.h"
 
 #include "bangclient_export.h"
 
+#include <future>
+#include <optional>
+
 #ifdef WIN32
     #define STDCALL __stdcall
 #else
@@ -16,6 +22,7 @@
 constexpr int window_width = 900;
 constexpr int window_height = 700;
 constexpr int max_fps = 300;
+constexpr int idle_fps = 20;
 
 #ifdef HAVE_GIT_CLIENT_VERSION
 extern "C" const char *const client_commit_hash;
@@ -31,60 +38,116 @@ extern "C" BANGCLIENT_EXPORT const char *STDCALL get_cards_commit_hash() {
 }
 #endif
 
-extern "C" BANGCLIENT_EXPORT long STDCALL entrypoint(const char *base_path) {
+// a startup benchmark run quits after the first frame and doesn't write back the config
+static long run_client(const char *base_path, auto &&on_start, bool startup_benchmark = false) {
     try {
+        startup_trace::reset();
+
+        startup_trace::span init_span{"sdl init"};
         sdl::initializer sdl_init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
         sdl::ttf_initializer sdl_ttf_init;
         sdl::img_initializer sdl_img_init(IMG_INIT_PNG | IMG_INIT_JPG);
+        init_span.end();
+
+        // the images and the config are decoded on workers while the window and the renderer are created,
+        // the textures are made on this thread once both are done
+        auto media_loader = std::async(std::launch::async, [&]{
+            return std::make_unique<media_pak>(base_path);
+        });
+        auto config_loader = std::async(std::launch::async, load_config);
 
         SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
 
+        startup_trace::span window_span{"window and renderer"};
         sdl::window window(_("BANG_TITLE").c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, window_width, window_height, SDL_WINDOW_RESIZABLE);
 
         sdl::renderer renderer(window, -1, SDL_RENDERER_ACCELERATED);
         SDL_SetRenderDrawBlendMode(renderer.get(), SDL_BLENDMODE_BLEND);
+        window_span.end();
         
-        media_pak resources{base_path, renderer};
+        startup_trace::span media_span{"media_pak upload"};
+        std::unique_ptr<media_pak> resources = media_loader.get();
+        resources->upload_textures(renderer);
         SDL_SetWindowIcon(window.get(), media_pak::get().icon_bang.get());
+        media_span.end();
 
-        client_manager mgr{window, renderer, base_path};
+        startup_trace::span manager_span{"client_manager"};
+        client_manager mgr{window, renderer, base_path, config_loader.get(), !startup_benchmark};
+        on_start(mgr);
+        manager_span.end();
+
+        std::optional<startup_trace::span> first_frame_span;
+        first_frame_span.emplace("first frame");
 
         sdl::event event;
         bool quit = false;
 
+        auto handle_event = [&](const sdl::event &ev) {
+            // only wakes up the loop, the messages are dispatched by the next tick
+            if (ev.type == client_manager::network_wake_event()) {
+                return;
+            }
+            switch (ev.type) {
+            case SDL_WINDOWEVENT:
+                if (ev.window.event == SDL_WINDOWEVENT_RESIZED) {
+                    mgr.refresh_layout();
+                } else {
+                    mgr.invalidate();
+                }
+                break;
+            case SDL_QUIT:
+                quit = true;
+                break;
+            default:
+                mgr.handle_event(ev);
+                break;
+            }
+        };
+
+        // vsync is enabled with the SDL_RENDER_VSYNC hint, then SDL_RenderPresent paces the animated frames
+        SDL_RendererInfo renderer_info;
+        const bool vsync = SDL_GetRendererInfo(renderer.get(), &renderer_info) == 0
+            && (renderer_info.flags & SDL_RENDERER_PRESENTVSYNC);
+
         using clock = std::chrono::steady_clock;
         using frames = std::chrono::duration<int64_t, std::ratio<1, max_fps>>;
+        using idle_frames = std::chrono::duration<int64_t, std::ratio<1, idle_fps>>;
 
-        auto next_frame = clock::now() + frames{0};
         auto last_tick = clock::now();
 
         while (!quit) {
-            next_frame += frames{1};
-
-            while (SDL_PollEvent(&event)) {
-                switch (event.type) {
-                case SDL_WINDOWEVENT:
-                    if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-                        mgr.refresh_layout();
+            // while nothing is moving, block on the event queue at the idle rate instead of spinning at max_fps
+            const bool animating = mgr.is_animating();
+            if (!animating || !vsync) {
+                auto next_frame = last_tick + (animating ? clock::duration{frames{1}} : clock::duration{idle_frames{1}});
+                auto timeout = std::chrono::ceil<std::chrono::milliseconds>(next_frame - clock::now());
+                if (SDL_WaitEventTimeout(&event, std::max(0, int(timeout.count())))) {
+                    handle_event(event);
+                    if (!vsync) {
+                        std::this_thread::sleep_until(last_tick + frames{1});
                     }
-                    break;
-                case SDL_QUIT:
-                    quit = true;
-                    break;
-                default:
-                    mgr.handle_event(event);
-                    break;
                 }
             }
 
+            while (SDL_PollEvent(&event)) {
+                handle_event(event);
+            }
+
             auto next_tick = clock::now();
             mgr.tick(next_tick - last_tick);
             last_tick = next_tick;
 
-            mgr.render(renderer);
-            SDL_RenderPresent(renderer.get());
-            
-            std::this_thread::sleep_until(next_frame);
+            if (mgr.needs_redraw()) {
+                mgr.render(renderer);
+                SDL_RenderPresent(renderer.get());
+                if (first_frame_span) {
+                    first_frame_span.reset();
+                    startup_trace::finish();
+                    if (startup_benchmark) {
+                        quit = true;
+                    }
+                }
+            }
         }
 
     } catch (const std::exception &error) {
@@ -96,4 +159,23 @@ extern "C" BANGCLIENT_EXPORT long STDCALL entrypoint(const char *base_path) {
     }
     
     return 0;
+}
+
+long run_client_first_frame(const char *base_path) {
+    return run_client(base_path, [](client_manager &) {}, true);
+}
+
+extern "C" BANGCLIENT_EXPORT long STDCALL entrypoint(const char *base_path) {
+    return run_client(base_path, [](client_manager &) {});
+}
+
+extern "C" BANGCLIENT_EXPORT long STDCALL replay(const char *base_path, const char *replay_file, const char *mode) {
+    auto parsed_mode = parse_replay_mode(mode ? mode : "original");
+    if (!parsed_mode) {
+        fmt::print(stderr, "Invalid replay mode: {} (expected original, max or step)\n", mode);
+        return 1;
+    }
+    return run_client(base_path, [&](client_manager &mgr) {
+        mgr.start_replay(replay_file, *parsed_mode);
+    });
 }
\ No newline at end of file
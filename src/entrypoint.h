@@ -0,0 +1,8 @@
+#ifndef __ENTRYPOINT_H__
+#define __ENTRYPOINT_H__
+
+// runs the client like entrypoint, then quits once the first frame is presented.
+// The config is read as usual but never saved
+long run_client_first_frame(const char *base_path);
+
+#endif
\ No newline at end of file
@@ -59,8 +59,7 @@ namespace banggame {
 
     void card_flip_animation::end() {
         if (flips) {
-            card->texture_front.reset();
-            card->texture_front_scaled.reset();
+            card->face.reset();
             card->flip_amt = 0.f;
         } else {
             card->flip_amt = 1.f;
@@ -2,6 +2,7 @@
 
 #include "net/options.h"
 #include "../media_pak.h"
+#include "../baked_image.h"
 
 #include <fmt/format.h>
 
@@ -24,12 +25,30 @@ namespace banggame {
     template<first_is_none T>
     struct skip_none : remove_first<enums::make_enum_sequence<T>> {};
 
+    static sdl::rect scaled_card_size(const sdl::rect &rect) {
+        return sdl::shrink_rect_to_width(rect, options.card_width);
+    }
+
+    static sdl::surface scale_to_card_width(const sdl::surface &surface) {
+        sdl::rect rect = scaled_card_size(surface.get_rect());
+        return sdl::scale_surface(surface, rect.w, rect.h);
+    }
+
     card_textures::card_textures(const std::filesystem::path &base_path, sdl::renderer &renderer)
-        : cards_pak_data(ifstream_or_throw(base_path / "cards.pak"))
-        , card_resources(cards_pak_data)
+        : card_resources(base_path / "cards.pak")
 
         , card_mask (get_card_resource("misc/card_mask"))
-        , card_border (renderer, get_card_resource("misc/card_border"))
+        , m_card_border_surface (scale_to_card_width(get_card_resource("misc/card_border")))
+
+        , m_atlas(renderer,
+            std::max({scaled_card_size(card_mask.get_rect()).w, m_card_border_surface.get_rect().w,
+                media_pak::get().sprite_cube.get_rect().w, media_pak::get().sprite_cube_border.get_rect().w}),
+            std::max({scaled_card_size(card_mask.get_rect()).h, m_card_border_surface.get_rect().h,
+                media_pak::get().sprite_cube.get_rect().h, media_pak::get().sprite_cube_border.get_rect().h}))
+
+        , card_border (m_atlas.add(m_card_border_surface))
+        , sprite_cube (m_atlas.add(media_pak::get().sprite_cube))
+        , sprite_cube_border (m_atlas.add(media_pak::get().sprite_cube_border))
 
         , rank_icons([&]<card_rank ... Es>(enums::enum_sequence<Es ...>) {
             return std::array {
@@ -43,50 +62,218 @@ namespace banggame {
             };
         }(skip_none<card_suit>()))
     {
+        if (std::filesystem::exists(base_path / "cards_baked.pak")) {
+            baked_resources.emplace(base_path / "cards_baked.pak");
+        }
+
         s_instance = this;
     }
 
-    sdl::texture_ref card_textures::get_backface_texture(std::string_view name, sdl::renderer &renderer) const {
+    const atlas_image *card_textures::get_backface_image(std::string_view name) const {
         if (auto it = backfaces.find(name); it != backfaces.end()) {
-            return it->second;
+            return &it->second;
         } else if (card_resources.contains(name)) {
-            return backfaces.emplace(std::piecewise_construct,
-                std::forward_as_tuple(name),
-                std::forward_as_tuple(renderer, apply_card_mask(get_card_resource(name)))
-            ).first->second;
+            return &backfaces.emplace(name, add_masked_card_image(name, {})).first->second;
         } else {
-            return {};
+            return nullptr;
         }
     }
+
+    atlas_image card_textures::add_card_image(const sdl::surface &full_size) const {
+        return m_atlas.add(scale_to_card_width(full_size));
+    }
     
     sdl::surface card_textures::apply_card_mask(const sdl::surface &source) const {
-        sdl::surface ret(card_mask.get()->w, card_mask.get()->h);
-        sdl::rect src_rect = source.get_rect();
-        sdl::rect dst_rect = ret.get_rect();
-        SDL_BlitSurface(source.get(), &src_rect, ret.get(), &dst_rect);
+        return sdl::apply_alpha_mask(source, card_mask);
+    }
 
-        SDL_LockSurface(card_mask.get());
-        SDL_LockSurface(ret.get());
+    // a surface sharing the pixels of surf, which must outlive it
+    static sdl::surface make_surface_view(const sdl::surface &surf) {
+        SDL_Surface *value = surf.get();
+        sdl::surface ret = SDL_CreateRGBSurfaceWithFormatFrom(value->pixels,
+            value->w, value->h, value->format->BitsPerPixel, value->pitch, value->format->format);
+        if (!ret) throw sdl::error(fmt::format("Could not create surface: {}", SDL_GetError()));
+        return ret;
+    }
 
-        const uint32_t amask = card_mask.get()->format->Amask;
+    sdl::surface card_textures::decode_masked_card(std::string_view name, const sdl::surface &mask) const {
+        if (baked_resources) {
+            if (auto key = fmt::format("full/{}", name); baked_resources->contains(key)) {
+                auto contents = baked_resources->read(key);
+                return sdl::load_baked_image(resource_view{contents.data(), contents.size()});
+            }
+        }
+        return sdl::apply_alpha_mask(get_card_resource(name), mask);
+    }
 
-        uint32_t *mask_ptr = static_cast<uint32_t *>(card_mask.get()->pixels);
-        uint32_t *surf_ptr = static_cast<uint32_t *>(ret.get()->pixels);
+    sdl::surface card_textures::decode_scaled_card(std::string_view name, const sdl::surface &masked) const {
+        if (baked_resources) {
+            if (auto key = fmt::format("scaled/{}", name); baked_resources->contains(key)) {
+                auto contents = baked_resources->read(key);
+                return sdl::load_baked_image(resource_view{contents.data(), contents.size()});
+            }
+        }
+        return scale_to_card_width(masked);
+    }
 
-        int npixels = ret.get()->w * ret.get()->h;
+    sdl::surface card_textures::get_masked_card(std::string_view name) const {
+        if (auto it = m_preloaded_cards.find(name); it != m_preloaded_cards.end() && it->second.masked) {
+            return make_surface_view(it->second.masked);
+        }
+        return decode_masked_card(name, card_mask);
+    }
 
-        for (int i=0; i<npixels; ++i) {
-            *surf_ptr = (*surf_ptr & (~amask)) | (*mask_ptr & amask);
-            ++mask_ptr;
-            ++surf_ptr;
+    atlas_image card_textures::add_masked_card_image(std::string_view name, const sdl::surface &masked) const {
+        if (auto it = m_preloaded_cards.find(name); it != m_preloaded_cards.end()) {
+            return m_atlas.add(it->second.scaled);
+        }
+        if (masked) {
+            return m_atlas.add(decode_scaled_card(name, masked));
+        } else {
+            return m_atlas.add(decode_scaled_card(name, get_masked_card(name)));
         }
+    }
 
-        SDL_UnlockSurface(ret.get());
-        SDL_UnlockSurface(card_mask.get());
+    std::vector<std::string> card_textures::get_preload_names(expansion_type expansions) const {
+        std::vector<std::string_view> directories{
+            "backface",
+            enums::to_string(card_deck_type::main_deck),
+            enums::to_string(card_deck_type::character),
+            enums::to_string(card_deck_type::role)
+        };
+        for (expansion_type E : enums::enum_values_v<expansion_type>) {
+            if (bool(expansions & E)) {
+                directories.push_back(enums::to_string(E));
+            }
+        }
 
+        std::vector<std::string> ret;
+        for (std::string_view name : card_resources.names()) {
+            if (rn::contains(directories, name.substr(0, name.find('/')))) {
+                ret.emplace_back(name);
+            }
+        }
         return ret;
     }
 
+    sdl::surface card_textures::make_card_surface(const card_face_key &key, float icon_scale) const {
+        sdl::surface card_base_surf;
+        try {
+            card_base_surf = get_masked_card(key.image);
+        } catch (const std::out_of_range &error) {
+            fmt::print("{}\n", error.what());
+            sdl::rect mask_rect = card_mask.get_rect();
+            card_base_surf = sdl::surface{mask_rect.w, mask_rect.h};
+            uint32_t color = SDL_MapRGBA(card_base_surf.get()->format, 0xff, 0x0, 0xff, 0xff);
+            SDL_FillRect(card_base_surf.get(), nullptr, color);
+            card_base_surf = apply_card_mask(card_base_surf);
+        }
+
+        if (key.has_sign()) {
+            if (card_base_surf.get()->flags & SDL_PREALLOC) {
+                card_base_surf = SDL_DuplicateSurface(card_base_surf.get());
+            }
+
+            sdl::rect card_rect = card_base_surf.get_rect();
+
+            const auto &card_rank_surf = rank_icons[enums::indexof(key.rank) - 1];
+            sdl::rect rank_rect = card_rank_surf.get_rect();
+
+            rank_rect.w = int(rank_rect.w * icon_scale);
+            rank_rect.h = int(rank_rect.h * icon_scale);
+            rank_rect.x = options.card_suit_offset;
+            rank_rect.y = card_rect.h - rank_rect.h - options.card_suit_offset;
+                
+            SDL_BlitScaled(card_rank_surf.get(), nullptr, card_base_surf.get(), &rank_rect);
+            
+            const auto &card_suit_surf = suit_icons[enums::indexof(key.suit) - 1];
+            sdl::rect suit_rect = card_suit_surf.get_rect();
+
+            suit_rect.w = int(suit_rect.w * icon_scale);
+            suit_rect.h = int(suit_rect.h * icon_scale);
+            suit_rect.x = rank_rect.x + rank_rect.w;
+            suit_rect.y = card_rect.h - suit_rect.h - options.card_suit_offset;
+
+            SDL_BlitScaled(card_suit_surf.get(), nullptr, card_base_surf.get(), &suit_rect);
+
+            // the base is already masked, only the area under the icons needs it again
+            sdl::rect icons_rect;
+            SDL_UnionRect(&rank_rect, &suit_rect, &icons_rect);
+            sdl::copy_alpha_channel(card_base_surf, card_mask, icons_rect);
+        }
+
+        return card_base_surf;
+    }
+
+    card_face_ptr card_textures::get_card_face(const card_face_key &key) const {
+        return m_faces.get(key, [&]{
+            card_face ret{key};
+            if (key.has_sign() || !card_resources.contains(key.image)) {
+                ret.scaled = add_card_image(make_card_surface(key, options.card_suit_scale));
+            } else {
+                ret.scaled = add_masked_card_image(key.image, {});
+            }
+            return ret;
+        });
+    }
+
+    sdl::texture_ref card_textures::get_overlay_texture(sdl::renderer &renderer, const card_face &face) const {
+        auto it = rn::find(m_overlay_textures, face.key, &overlay_texture::key);
+        if (it == m_overlay_textures.end()) {
+            if (m_overlay_textures.size() >= max_overlay_textures) {
+                m_overlay_textures.pop_back();
+            }
+            m_overlay_textures.push_front(overlay_texture{face.key, sdl::texture(renderer, make_card_surface(face.key, 1.f))});
+            ++m_overlay_textures_created;
+        } else if (it != m_overlay_textures.begin()) {
+            m_overlay_textures.splice(m_overlay_textures.begin(), m_overlay_textures, it);
+        }
+        return m_overlay_textures.front().texture;
+    }
+
+    void card_textures::release_overlay_textures() const {
+        m_overlay_textures.clear();
+    }
+
+    card_textures::overlay_stats card_textures::get_overlay_stats() const {
+        const size_t full_size_bytes = size_t(card_mask.get()->w) * card_mask.get()->h * 4;
+
+        overlay_stats ret;
+        ret.created = m_overlay_textures_created;
+        ret.resident_bytes = m_overlay_textures.size() * full_size_bytes;
+        ret.saved_bytes = m_faces.size() * full_size_bytes - std::min(m_faces.size() * full_size_bytes, ret.resident_bytes);
+        return ret;
+    }
+
+    void card_textures::add_preloaded_card(std::string_view name, sdl::surface masked, sdl::surface scaled) {
+        if (name.starts_with("backface/")) {
+            if (!backfaces.contains(name)) {
+                backfaces.emplace(name, m_atlas.add(scaled));
+            }
+        } else {
+            constexpr auto surface_bytes = [](const sdl::surface &surf) {
+                return size_t(surf.get()->h) * surf.get()->pitch;
+            };
+            m_preloaded_bytes += surface_bytes(scaled);
+            if (m_preloaded_bytes + surface_bytes(masked) > max_preloaded_bytes) {
+                masked.reset();
+            } else {
+                m_preloaded_bytes += surface_bytes(masked);
+            }
+            m_preloaded_cards.emplace(name, preloaded_card{std::move(masked), std::move(scaled)});
+
+            // characters and roles are drawn without a sign, so their face is known and can go in the atlas now.
+            // No card_view holds these yet, past the budget of unused faces they would only be evicted
+            const std::string_view directory = name.substr(0, name.find('/'));
+            if (m_prewarmed_faces < max_unused_faces && (directory == enums::to_string(card_deck_type::character)
+                || directory == enums::to_string(card_deck_type::role)))
+            {
+                get_card_face(card_face_key{std::string(name), card_rank::none, card_suit::none});
+                ++m_prewarmed_faces;
+            }
+        }
+    }
+
     static std::string parse_image(std::string_view image, card_deck_type deck, bool backface = false) {
         auto colon_index = image.find(':');
         if (backface) {
@@ -106,79 +293,36 @@ namespace banggame {
     }
 
     void card_view::make_texture_front(sdl::renderer &renderer) {
-        auto do_make_texture = [&](float scale) {
-            sdl::surface card_base_surf;
-            try {
-                card_base_surf = card_textures::get().get_card_resource(parse_image(image, deck));
-            } catch (const std::out_of_range &error) {
-                fmt::print("{}\n", error.what());
-                sdl::rect mask_rect = card_textures::get().card_mask.get_rect();
-                card_base_surf = sdl::surface{mask_rect.w, mask_rect.h};
-                uint32_t color = SDL_MapRGBA(card_base_surf.get()->format, 0xff, 0x0, 0xff, 0xff);
-                SDL_FillRect(card_base_surf.get(), nullptr, color);
-            }
-
-            if (sign) {
-                sdl::rect card_rect = card_base_surf.get_rect();
-
-                const auto &card_rank_surf = card_textures::get().rank_icons[enums::indexof(sign.rank) - 1];
-                sdl::rect rank_rect = card_rank_surf.get_rect();
-
-                rank_rect.w = int(rank_rect.w * scale);
-                rank_rect.h = int(rank_rect.h * scale);
-                rank_rect.x = options.card_suit_offset;
-                rank_rect.y = card_rect.h - rank_rect.h - options.card_suit_offset;
-                    
-                SDL_BlitScaled(card_rank_surf.get(), nullptr, card_base_surf.get(), &rank_rect);
-                
-                const auto &card_suit_surf = card_textures::get().suit_icons[enums::indexof(sign.suit) - 1];
-                sdl::rect suit_rect = card_suit_surf.get_rect();
-
-                suit_rect.w = int(suit_rect.w * scale);
-                suit_rect.h = int(suit_rect.h * scale);
-                suit_rect.x = rank_rect.x + rank_rect.w;
-                suit_rect.y = card_rect.h - suit_rect.h - options.card_suit_offset;
-
-                SDL_BlitScaled(card_suit_surf.get(), nullptr, card_base_surf.get(), &suit_rect);
-            }
-
-            return card_base_surf;
-        };
-
-        sdl::surface surface_front = card_textures::get().apply_card_mask(do_make_texture(1.f));
-        texture_front = sdl::texture(renderer, surface_front);
-
-        sdl::surface scaled = card_textures::get().apply_card_mask(do_make_texture(options.card_suit_scale));
-        sdl::surface surface_front_scaled = sdl::scale_surface(scaled, scaled.get_rect().w / options.card_width);
-        texture_front_scaled = sdl::texture(renderer, surface_front_scaled);
+        face = card_textures::get().get_card_face(card_face_key{parse_image(image, deck), sign.rank, sign.suit});
     }
 
     void card_view::make_texture_back(sdl::renderer &renderer) {
-        texture_back = card_textures::get().get_backface_texture(parse_image(image, deck, true), renderer);
+        texture_back = card_textures::get().get_backface_image(parse_image(image, deck, true));
     }
 
     void role_card::make_texture_front(sdl::renderer &renderer) {
-        sdl::surface surface_front = card_textures::get().apply_card_mask(
-            card_textures::get().get_card_resource(fmt::format("role/{}", enums::to_string(role))));
-        texture_front = sdl::texture(renderer, surface_front);
-        texture_front_scaled = sdl::texture(renderer, sdl::scale_surface(surface_front,
-            texture_front.get_rect().w / options.card_width));
+        face = card_textures::get().get_card_face(card_face_key{fmt::format("role/{}", enums::to_string(role)), card_rank::none, card_suit::none});
     }
 
     void role_card::make_texture_back(sdl::renderer &renderer) {
-        texture_back = card_textures::get().get_backface_texture(parse_image("", card_deck_type::role, true), renderer);
+        texture_back = card_textures::get().get_backface_image(parse_image("", card_deck_type::role, true));
     }
 
     void cube_widget::render(sdl::renderer &renderer, render_flags flags) {
-        auto do_render = [&](sdl::texture_ref tex, sdl::color color = sdl::rgb(0xffffff)) {
-            tex.render_colored(renderer, sdl::move_rect_center(tex.get_rect(), pos), color);
+        render_batch batch{renderer};
+        render(batch, flags);
+    }
+
+    void cube_widget::render(render_batch &batch, render_flags flags) {
+        auto do_render = [&](const atlas_image &image, sdl::color color = sdl::rgb(0xffffff)) {
+            batch.add(image, sdl::move_rect_center(image.get_rect(), pos), sdl::render_ex_options{ .color_modifier = color });
         };
 
         if (bool(flags & render_flags::no_skip_animating) || !animating) {
             if (auto style = get_style()) {
-                do_render(media_pak::get().sprite_cube_border, cube_border_color(*style));
+                do_render(card_textures::get().sprite_cube_border, cube_border_color(*style));
             }
-            do_render(media_pak::get().sprite_cube);
+            do_render(card_textures::get().sprite_cube);
         }
     }
 
@@ -187,15 +331,15 @@ namespace banggame {
         m_pos = new_pos;
     }
 
-    sdl::rect card_view::get_base_rect(sdl::texture_ref tex) const {
-        sdl::rect rect = tex.get_rect();
+    sdl::rect card_view::get_base_rect(const atlas_image &image) const {
+        sdl::rect rect = image.get_rect();
         sdl::scale_rect_width(rect, options.card_width);
         return sdl::move_rect_center(rect, m_pos);
     }
 
     sdl::rect card_view::get_rect() const {
-        if (sdl::texture_ref tex = get_texture()) {
-            sdl::rect rect = get_base_rect(tex);
+        if (const atlas_image *image = get_image()) {
+            sdl::rect rect = get_base_rect(*image);
             if (inactive) {
                 return sdl::move_rect_center(sdl::rect{0, 0, rect.h, rect.w}, sdl::rect_center(rect));
             } else {
@@ -205,10 +349,10 @@ namespace banggame {
         return sdl::rect{};
     }
 
-    sdl::texture_ref card_view::get_texture() const {
-        if (flip_amt > 0.5f && texture_front_scaled) {
-            return texture_front_scaled;
-        } else if (texture_back) {
+    const atlas_image *card_view::get_image() const {
+        if (flip_amt > 0.5f && face && face->scaled) {
+            return &face->scaled;
+        } else if (texture_back && *texture_back) {
             return texture_back;
         } else {
             return nullptr;
@@ -216,10 +360,15 @@ namespace banggame {
     }
 
     void card_view::render(sdl::renderer &renderer, render_flags flags) {
-        sdl::texture_ref tex = get_texture();
-        if (!tex || animating && !bool(flags & render_flags::no_skip_animating)) return;
+        render_batch batch{renderer};
+        render(batch, flags);
+    }
+
+    void card_view::render(render_batch &batch, render_flags flags) {
+        const atlas_image *image = get_image();
+        if (!image || animating && !bool(flags & render_flags::no_skip_animating)) return;
 
-        sdl::rect rect = get_base_rect(tex);
+        sdl::rect rect = get_base_rect(*image);
         float wscale = std::abs(1.f - 2.f * flip_amt);
         rect.x += int(rect.w * (1.f - wscale) * 0.5f);
         rect.w = int(rect.w * wscale);
@@ -231,7 +380,7 @@ namespace banggame {
             }
             border_color = sdl::lerp_color(border_color, colors.flash_card, flash_amt);
             if (border_color.a) {
-                card_textures::get().card_border.render_ex(renderer, sdl::rect{
+                batch.add(card_textures::get().card_border, sdl::rect{
                     rect.x - options.default_border_thickness,
                     rect.y - options.default_border_thickness,
                     rect.w + options.default_border_thickness * 2,
@@ -243,10 +392,10 @@ namespace banggame {
             }
         }
 
-        tex.render_ex(renderer, rect, sdl::render_ex_options{ .angle = rotation });
+        batch.add(*image, rect, sdl::render_ex_options{ .angle = rotation });
 
         for (auto &cube : cubes) {
-            cube->render(renderer);
+            cube->render(batch);
         }
     }
 
@@ -273,26 +422,29 @@ namespace banggame {
     }
 
     void pocket_view_base::render(sdl::renderer &renderer) {
+        render_batch batch{renderer};
         for (card_view *c : *this) {
-            c->render(renderer);
+            c->render(batch);
         }
     }
 
     void pocket_view_base::render_first(sdl::renderer &renderer, int ncards) {
+        render_batch batch{renderer};
         for (card_view *c : *this | rv::take(ncards)) {
-            c->render(renderer);
+            c->render(batch);
         }
     }
     
     void pocket_view_base::render_last(sdl::renderer &renderer, int ncards) {
         if (!empty()) {
+            render_batch batch{renderer};
             for (card_view *c : *this
                 | rv::take_last(ncards)
                 | rv::drop_last(1)
             ) {
-                c->render(renderer, render_flags::no_draw_border);
+                c->render(batch, render_flags::no_draw_border);
             }
-            back()->render(renderer);
+            back()->render(batch);
         }
     }
 
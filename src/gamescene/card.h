@@ -5,16 +5,20 @@
 #include "game/game_update.h"
 
 #include "sdl_wrap.h"
-#include "utils/unpacker.h"
+#include "pak_file.h"
 
 #include "options.h"
 #include "game_styles.h"
+#include "texture_atlas.h"
+#include "card_face_cache.h"
 
 #include "../widgets/stattext.h"
 
 #include <filesystem>
+#include <list>
 #include <vector>
 #include <memory>
+#include <optional>
 
 namespace banggame {
 
@@ -24,27 +28,112 @@ namespace banggame {
 
         static inline card_textures *s_instance = nullptr;
 
-        std::ifstream cards_pak_data;
-        const unpacker<std::ifstream> card_resources;
+        const pak_file card_resources;
+
+        // cards decoded ahead of time by bangbake, if cards_baked.pak was built
+        std::optional<pak_file> baked_resources;
+
+        struct preloaded_card {
+            sdl::surface masked;
+            sdl::surface scaled;
+        };
+
+        // card images decoded by card_preloader. Both sizes count towards max_preloaded_bytes,
+        // past it only the scaled images are kept
+        std::map<std::string, preloaded_card, std::less<>> m_preloaded_cards;
+        size_t m_preloaded_bytes = 0;
+
+        // faces put in the face cache by add_preloaded_card, up to max_unused_faces
+        size_t m_prewarmed_faces = 0;
+
+        static constexpr size_t max_preloaded_bytes = 64 << 20;
 
         friend class game_scene;
+        friend class card_preloader;
 
     public:
         sdl::surface card_mask;
-        sdl::texture card_border;
 
-        mutable std::map<std::string, sdl::texture, std::less<>> backfaces;
+    private:
+        sdl::surface m_card_border_surface;
+
+        // holds everything that is drawn at card size: faces, backfaces, borders and cubes
+        mutable texture_atlas m_atlas;
+
+        static constexpr size_t max_unused_faces = 64;
+        mutable card_face_cache m_faces{max_unused_faces};
+
+        struct overlay_texture {
+            card_face_key key;
+            sdl::texture texture;
+        };
+
+        // the most recently used at the front
+        static constexpr size_t max_overlay_textures = 8;
+        mutable std::list<overlay_texture> m_overlay_textures;
+        mutable size_t m_overlay_textures_created = 0;
+
+    public:
+        atlas_image card_border;
+        atlas_image sprite_cube;
+        atlas_image sprite_cube_border;
+
+        mutable std::map<std::string, atlas_image, std::less<>> backfaces;
 
         std::array<sdl::surface, enums::num_members_v<card_rank> - 1> rank_icons;
         std::array<sdl::surface, enums::num_members_v<card_suit> - 1> suit_icons;
 
-        sdl::texture_ref get_backface_texture(std::string_view name, sdl::renderer &renderer) const;
+        const atlas_image *get_backface_image(std::string_view name) const;
         sdl::surface apply_card_mask(const sdl::surface &source) const;
 
+        // shrinks a full size card image to the card width and packs it in the atlas
+        atlas_image add_card_image(const sdl::surface &full_size) const;
+
+        // card image with the card mask applied. If it was preloaded the surface
+        // points into memory owned by card_textures and must not be written to, see SDL_PREALLOC
+        sdl::surface get_masked_card(std::string_view name) const;
+
+        // same as add_card_image, taking the preloaded or baked scaled image if there is one
+        atlas_image add_masked_card_image(std::string_view name, const sdl::surface &masked) const;
+
         sdl::surface get_card_resource(std::string_view name) const {
             return sdl::surface(card_resources[name]);
         }
 
+        // masked card image with the rank and suit icons drawn at icon_scale, magenta if the image is missing
+        sdl::surface make_card_surface(const card_face_key &key, float icon_scale) const;
+
+        card_face_ptr get_card_face(const card_face_key &key) const;
+
+        const card_face_stats &get_face_stats() const {
+            return m_faces.stats();
+        }
+
+        // full size texture of a face for the zoomed overlay, made on first use
+        sdl::texture_ref get_overlay_texture(sdl::renderer &renderer, const card_face &face) const;
+
+        // frees the overlay textures, which are made again when needed
+        void release_overlay_textures() const;
+
+        struct overlay_stats {
+            size_t created = 0;
+            size_t resident_bytes = 0;
+
+            // full size textures of the cached faces which are not resident
+            size_t saved_bytes = 0;
+        };
+
+        overlay_stats get_overlay_stats() const;
+
+        // names of the card images likely to be used in a game with these expansions
+        std::vector<std::string> get_preload_names(expansion_type expansions) const;
+
+        // these only read the paks and can be called from any thread, with a private copy of card_mask
+        sdl::surface decode_masked_card(std::string_view name, const sdl::surface &mask) const;
+        sdl::surface decode_scaled_card(std::string_view name, const sdl::surface &masked) const;
+
+        void add_preloaded_card(std::string_view name, sdl::surface masked, sdl::surface scaled);
+
         static const card_textures &get() {
             return *s_instance;
         }
@@ -65,6 +154,7 @@ namespace banggame {
         bool animating = false;
 
         void render(sdl::renderer &renderer, render_flags flags = {});
+        void render(render_batch &batch, render_flags flags = {});
     };
 
     class cube_pile_base : public std::vector<std::unique_ptr<cube_widget>> {
@@ -75,8 +165,9 @@ namespace banggame {
         virtual sdl::point get_offset(cube_widget *cube) const = 0;
 
         void render(sdl::renderer &renderer) {
+            render_batch batch{renderer};
             for (auto &cube : *this) {
-                cube->render(renderer);
+                cube->render(batch);
             }
         }
     };
@@ -125,19 +216,19 @@ namespace banggame {
         }
 
         sdl::rect get_rect() const;
-        sdl::texture_ref get_texture() const;
+        const atlas_image *get_image() const;
         void render(sdl::renderer &renderer, render_flags flags = {});
+        void render(render_batch &batch, render_flags flags = {});
 
-        sdl::texture texture_front;
-        sdl::texture texture_front_scaled;
+        card_face_ptr face;
 
-        sdl::texture_ref texture_back;
+        const atlas_image *texture_back = nullptr;
         
         void make_texture_front(sdl::renderer &renderer);
         void make_texture_back(sdl::renderer &renderer);
 
     private:
-        sdl::rect get_base_rect(sdl::texture_ref tex) const;
+        sdl::rect get_base_rect(const atlas_image &image) const;
         sdl::point m_pos;
     };
 
@@ -0,0 +1,43 @@
+#include "card_face_cache.h"
+
+#include <algorithm>
+
+namespace banggame {
+
+    card_face_ptr card_face_cache::get(const card_face_key &key, const std::function<card_face()> &make_face) {
+        if (auto it = m_entries.find(key); it != m_entries.end()) {
+            ++m_stats.hits;
+            m_lru.splice(m_lru.end(), m_lru, it->second.lru_it);
+            return it->second.face;
+        }
+
+        ++m_stats.misses;
+        auto face = std::make_shared<card_face>(make_face());
+
+        auto [it, inserted] = m_entries.emplace(key, cache_entry{face});
+        it->second.lru_it = m_lru.insert(m_lru.end(), &it->first);
+
+        evict_unused();
+        return face;
+    }
+
+    void card_face_cache::evict_unused() {
+        // the cache holds the only reference to faces that no card_view is showing
+        size_t num_unused = std::ranges::count_if(m_entries, [](const auto &pair) {
+            return pair.second.face.use_count() == 1;
+        });
+
+        for (auto it = m_lru.begin(); num_unused > m_max_unused && it != m_lru.end();) {
+            auto entry_it = m_entries.find(**it);
+            if (entry_it->second.face.use_count() == 1) {
+                it = m_lru.erase(it);
+                m_entries.erase(entry_it);
+                ++m_stats.evictions;
+                --num_unused;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef __CARD_FACE_CACHE_H__
+#define __CARD_FACE_CACHE_H__
+
+#include "cards/card_enums.h"
+
+#include "texture_atlas.h"
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace banggame {
+
+    struct card_face_key {
+        std::string image;
+        card_rank rank;
+        card_suit suit;
+
+        bool has_sign() const {
+            return rank != card_rank::none && suit != card_suit::none;
+        }
+
+        auto operator <=> (const card_face_key &other) const = default;
+    };
+
+    // The front of a card, shared by every card_view showing the same image and sign.
+    // The full size texture is only made when the overlay needs it, see card_textures::get_overlay_texture
+    struct card_face {
+        card_face_key key;
+        atlas_image scaled;
+    };
+
+    using card_face_ptr = std::shared_ptr<const card_face>;
+
+    struct card_face_stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+
+        double hit_rate() const {
+            return hits + misses == 0 ? 0.0 : double(hits) / (hits + misses);
+        }
+    };
+
+    // Faces stay cached after the last card_view showing them lets go, so that hiding and showing
+    // a card again doesn't recreate them. At most max_unused of those are kept, the least recently used go first
+    class card_face_cache {
+    public:
+        explicit card_face_cache(size_t max_unused)
+            : m_max_unused(max_unused) {}
+
+        card_face_ptr get(const card_face_key &key, const std::function<card_face()> &make_face);
+
+        const card_face_stats &stats() const {
+            return m_stats;
+        }
+
+        size_t size() const {
+            return m_entries.size();
+        }
+
+    private:
+        void evict_unused();
+
+        using lru_list = std::list<const card_face_key *>;
+
+        struct cache_entry {
+            std::shared_ptr<card_face> face;
+            lru_list::iterator lru_it;
+        };
+
+        size_t m_max_unused;
+
+        std::map<card_face_key, cache_entry> m_entries;
+
+        // the most recently used at the back
+        lru_list m_lru;
+
+        card_face_stats m_stats;
+    };
+
+}
+
+#endif
\ No newline at end of file
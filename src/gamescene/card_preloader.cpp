@@ -0,0 +1,70 @@
+#include "card_preloader.h"
+
+#include <algorithm>
+
+namespace banggame {
+
+    static constexpr size_t max_preload_workers = 4;
+
+    card_preloader::card_preloader(card_textures &textures, std::vector<std::string> names)
+        : m_textures(textures)
+        , m_names(std::move(names))
+    {
+        size_t num_workers = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, max_preload_workers + 1) - 1;
+        num_workers = std::min(num_workers, m_names.size());
+
+        m_card_masks.reserve(num_workers);
+        for (size_t i = 0; i < num_workers; ++i) {
+            m_card_masks.emplace_back(SDL_DuplicateSurface(textures.card_mask.get()));
+        }
+        for (const sdl::surface &card_mask : m_card_masks) {
+            m_workers.emplace_back(&card_preloader::worker_main, this, std::cref(card_mask));
+        }
+    }
+
+    card_preloader::~card_preloader() {
+        m_stopped = true;
+        for (std::thread &worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    void card_preloader::worker_main(const sdl::surface &card_mask) {
+        while (!m_stopped) {
+            size_t index = m_next_index++;
+            if (index >= m_names.size()) break;
+
+            std::string_view name = m_names[index];
+            decoded_card result{name};
+            try {
+                result.masked = m_textures.decode_masked_card(name, card_mask);
+                result.scaled = m_textures.decode_scaled_card(name, result.masked);
+            } catch (const std::exception &error) {
+                fmt::print(stderr, "Could not preload {}: {}\n", name, error.what());
+            }
+
+            std::scoped_lock lock{m_decoded_mutex};
+            m_decoded.push_back(std::move(result));
+        }
+    }
+
+    bool card_preloader::upload(size_t max_count) {
+        std::vector<decoded_card> batch;
+        {
+            std::scoped_lock lock{m_decoded_mutex};
+            size_t count = std::min(max_count, m_decoded.size());
+            batch.assign(std::make_move_iterator(m_decoded.end() - count), std::make_move_iterator(m_decoded.end()));
+            m_decoded.resize(m_decoded.size() - count);
+        }
+
+        for (decoded_card &card : batch) {
+            if (card.masked && card.scaled) {
+                m_textures.add_preloaded_card(card.name, std::move(card.masked), std::move(card.scaled));
+            }
+        }
+
+        m_num_done += batch.size();
+        return m_num_done == m_names.size();
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef __CARD_PRELOADER_H__
+#define __CARD_PRELOADER_H__
+
+#include "card.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace banggame {
+
+    // Decodes and masks card images on worker threads, the results are
+    // handed over to card_textures on the main thread a few at a time
+    class card_preloader {
+    public:
+        card_preloader(card_textures &textures, std::vector<std::string> names);
+        ~card_preloader();
+
+        card_preloader(const card_preloader &) = delete;
+        card_preloader &operator = (const card_preloader &) = delete;
+
+        // moves at most max_count decoded images into card_textures, which puts the faces of characters
+        // and roles in the atlas right away. Returns true when all are done
+        bool upload(size_t max_count);
+
+    private:
+        struct decoded_card {
+            std::string_view name;
+            sdl::surface masked;
+            sdl::surface scaled;
+        };
+
+        void worker_main(const sdl::surface &card_mask);
+
+        card_textures &m_textures;
+        std::vector<std::string> m_names;
+
+        std::atomic<size_t> m_next_index = 0;
+        std::atomic<bool> m_stopped = false;
+
+        std::mutex m_decoded_mutex;
+        std::vector<decoded_card> m_decoded;
+        size_t m_num_done = 0;
+
+        // SDL_LockSurface is not thread safe, so each worker reads its own copy of the mask
+        std::vector<sdl::surface> m_card_masks;
+        std::vector<std::thread> m_workers;
+    };
+
+}
+
+#endif
\ No newline at end of file
@@ -11,9 +11,23 @@
 using namespace banggame;
 using namespace sdl::point_math;
 
-game_scene::game_scene(client_manager *parent)
+// preloaded card images handed over to card_textures each tick
+static constexpr size_t preload_batch_size = 8;
+
+// updates that add or remove cards or players
+static bool changes_context(const game_update &update) {
+    return enums::visit_indexed(overloaded{
+        [](UPD_TAG(add_cards), auto && ...) { return true; },
+        [](UPD_TAG(remove_cards), auto && ...) { return true; },
+        [](UPD_TAG(player_add), auto && ...) { return true; },
+        [](auto && ...) { return false; }
+    }, update);
+}
+
+game_scene::game_scene(client_manager *parent, const game_options &lobby_options)
     : scene_base(parent)
     , m_card_textures(parent->get_base_path(), parent->get_renderer())
+    , m_preloader(std::in_place, m_card_textures, m_card_textures.get_preload_names(lobby_options.expansions))
     , m_ui(this)
     , m_target(this)
 {
@@ -59,6 +73,7 @@ void game_scene::refresh_layout() {
 }
 
 void game_scene::tick(duration_type time_elapsed) {
+    card_view *prev_overlay = m_overlay;
     if (m_mouse_motion_timer >= options.card_overlay_duration) {
         if (!m_overlay) {
             m_overlay = std::get<card_view *>(find_card_at(m_mouse_pt));
@@ -69,16 +84,43 @@ void game_scene::tick(duration_type time_elapsed) {
         }
         m_mouse_motion_timer += time_elapsed;
     }
+    if (m_overlay != prev_overlay) {
+        parent->invalidate();
+    }
+
+    if (m_preloader && m_preloader->upload(preload_batch_size)) {
+        m_preloader.reset();
+    }
+
+    if (m_sounds) {
+        m_sounds->update();
+    }
 
     try {
         anim_duration_type tick_time{time_elapsed};
         while (true) {
             if (m_animations.empty()) {
                 if (!m_pending_updates.empty()) {
+                    bool was_counted = std::holds_alternative<json::json>(m_pending_updates.front());
+                    auto update = std::visit(overloaded{
+                        [&](decoded_update &decoded) {
+                            if (decoded.generation != m_context.generation()) {
+                                throw std::runtime_error("client.tick: stale decoded update");
+                            }
+                            return std::move(decoded.update);
+                        },
+                        [&](const json::json &value) {
+                            return json::deserialize<banggame::game_update>(value, context());
+                        }
+                    }, m_pending_updates.front());
+                    m_pending_updates.pop_front();
+                    if (was_counted || changes_context(update)) {
+                        --m_queued_context_changes;
+                    }
+
                     enums::visit_indexed([this](auto && ... args) {
                         handle_game_update(FWD(args) ...);
-                    }, json::deserialize<banggame::game_update>(m_pending_updates.front(), context()));
-                    m_pending_updates.pop_front();
+                    }, update);
                 } else {
                     break;
                 }
@@ -141,12 +183,13 @@ void game_scene::render(sdl::renderer &renderer) {
     m_ui.render(renderer);
     m_button_row.render(renderer);
 
-    if (m_overlay && m_overlay->known) {
-        sdl::rect rect = m_overlay->texture_front.get_rect();
+    if (m_overlay && m_overlay->known && m_overlay->face) {
+        sdl::texture_ref texture = m_card_textures.get_overlay_texture(renderer, *m_overlay->face);
+        sdl::rect rect = texture.get_rect();
         sdl::rect card_rect = m_overlay->get_rect();
         rect.x = std::clamp(card_rect.x + (card_rect.w - rect.w) / 2, 0, parent->width() - rect.w);
         rect.y = std::clamp(card_rect.y + (card_rect.h - rect.h) / 2, 0, parent->height() -  rect.h);
-        m_overlay->texture_front.render(renderer, rect);
+        texture.render(renderer, rect);
     }
 }
 
@@ -196,6 +239,9 @@ void game_scene::handle_event(const sdl::event &event) {
             parent->enable_chat();
         }
         break;
+    case SDL_APP_LOWMEMORY:
+        m_card_textures.release_overlay_textures();
+        break;
     }
 }
 
@@ -261,8 +307,23 @@ void game_scene::play_sound(std::string_view sound_id) {
     }
 }
 
-void game_scene::handle_message(SRV_TAG(game_update), const json::json &update) {
-    m_pending_updates.push_back(update);
+void game_scene::handle_message(SRV_TAG(game_update), json::json update) {
+    // decoding binds card and player pointers, which are only safe to keep
+    // if no update queued before this one adds or removes them
+    if (m_queued_context_changes == 0) {
+        try {
+            auto decoded = json::deserialize<game_update>(update, context());
+            if (changes_context(decoded)) {
+                ++m_queued_context_changes;
+            }
+            m_pending_updates.emplace_back(decoded_update{std::move(decoded), m_context.generation()});
+            return;
+        } catch (const std::exception &) {
+            // the error is reported when the update is decoded again at dispatch
+        }
+    }
+    ++m_queued_context_changes;
+    m_pending_updates.emplace_back(std::move(update));
 }
 
 void game_scene::handle_message(SRV_TAG(lobby_owner), const user_id_args &args) {
@@ -404,7 +465,7 @@ void game_scene::handle_game_update(UPD_TAG(add_cards), const add_cards_update &
     auto &pocket = get_pocket(args.pocket, args.player);
 
     for (auto [id, deck] : args.card_ids) {
-        card_view *card = &m_context.cards.emplace(id);
+        card_view *card = &m_context.add_card(id);
         card->deck = deck;
         card->make_texture_back(parent->get_renderer());
         
@@ -423,7 +484,7 @@ void game_scene::handle_game_update(UPD_TAG(remove_cards), const remove_cards_up
         if (c->pocket) {
             c->pocket->erase_card(c);
         }
-        m_context.cards.erase(c->id);
+        m_context.erase_card(c->id);
     }
 }
 
@@ -566,7 +627,7 @@ void game_scene::move_player_views(anim_duration_type duration) {
 
 void game_scene::handle_game_update(UPD_TAG(player_add), const player_add_update &args) {
     for (auto [player_id, user_id] : args.players) {
-        auto [p, inserted] = m_context.players.try_emplace(this, player_id, user_id);
+        auto [p, inserted] = m_context.add_player(this, player_id, user_id);
         if (inserted) {
             m_alive_players.push_back(&p);
         }
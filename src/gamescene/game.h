@@ -8,12 +8,14 @@
 #include "game_ui.h"
 
 #include "target_finder.h"
+#include "card_preloader.h"
 
 #include "utils/id_map.h"
 #include "utils/utils.h"
 
 #include <deque>
 #include <random>
+#include <variant>
 
 namespace banggame {
 
@@ -35,8 +37,39 @@ namespace banggame {
             }
             throw std::runtime_error(fmt::format("client.find_player: ID {} not found", id));
         }
+
+        card_view &add_card(int id) {
+            ++m_generation;
+            return cards.emplace(id);
+        }
+
+        template<typename ... Ts>
+        auto add_player(Ts && ... args) {
+            ++m_generation;
+            return players.try_emplace(FWD(args) ...);
+        }
+
+        void erase_card(int id) {
+            ++m_generation;
+            cards.erase(id);
+        }
+
+        // bumped whenever a card or player is added or removed
+        size_t generation() const {
+            return m_generation;
+        }
+
+    private:
+        size_t m_generation = 0;
+    };
+
+    struct decoded_update {
+        game_update update;
+        size_t generation;
     };
 
+    using pending_update = std::variant<decoded_update, json::json>;
+
     class game_scene : public scene_base,
     public message_handler<server_message_type::game_update>,
     public message_handler<server_message_type::lobby_owner>,
@@ -44,16 +77,17 @@ namespace banggame {
     public message_handler<server_message_type::lobby_add_user>,
     public message_handler<server_message_type::lobby_remove_user> {
     public:
-        game_scene(client_manager *parent);
+        game_scene(client_manager *parent, const game_options &lobby_options = {});
         
         void refresh_layout() override;
         void tick(duration_type time_elapsed) override;
+        bool is_animating() const override { return has_pending_updates(); }
         void render(sdl::renderer &renderer) override;
         void handle_event(const sdl::event &event) override;
 
         void play_sound(std::string_view sound_id);
 
-        void handle_message(SRV_TAG(game_update), const json::json &update) override;
+        void handle_message(SRV_TAG(game_update), json::json update) override;
         void handle_message(SRV_TAG(lobby_owner), const user_id_args &args) override;
         void handle_message(SRV_TAG(lobby_error), const std::string &message) override;
         void handle_message(SRV_TAG(lobby_add_user), const user_info_id_args &args) override;
@@ -71,6 +105,10 @@ namespace banggame {
             return bool(m_game_flags & flags);
         }
 
+        bool has_pending_updates() const {
+            return !m_pending_updates.empty() || !m_animations.empty();
+        }
+
     private:
         void handle_game_update(UPD_TAG(game_error),       const game_string &args);
         void handle_game_update(UPD_TAG(game_log),         const game_string &args);
@@ -120,6 +158,7 @@ namespace banggame {
 
         std::optional<sounds_pak> m_sounds;
         card_textures m_card_textures;
+        std::optional<card_preloader> m_preloader;
 
         game_context_view m_context;
 
@@ -127,7 +166,12 @@ namespace banggame {
 
         target_finder m_target;
 
-        std::deque<json::json> m_pending_updates;
+        std::deque<pending_update> m_pending_updates;
+
+        // queued updates that may add or remove cards or players,
+        // updates received after them are kept as json until dispatch
+        size_t m_queued_context_changes = 0;
+
         std::deque<animation> m_animations;
 
         counting_pocket m_shop_deck{pocket_type::shop_deck};
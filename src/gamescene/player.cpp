@@ -107,10 +107,10 @@ namespace banggame {
             if (!self->m_backup_characters.empty()) {
                 card_view *character = self->m_backup_characters.front();
                 character->render(renderer);
-                if (self->hp > 5) {
+                if (self->hp > 5 && character->texture_back) {
                     sdl::rect hp_marker_rect = character->get_rect();
                     hp_marker_rect.y += options.one_hp_size * 5;
-                    character->texture_back.render(renderer, hp_marker_rect);
+                    character->texture_back->render(renderer, hp_marker_rect);
                 }
             }
             for (card_view *c : self->m_characters) {
@@ -0,0 +1,190 @@
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace banggame {
+
+    atlas_image::~atlas_image() {
+        reset();
+    }
+
+    atlas_image::atlas_image(atlas_image &&other) noexcept
+        : m_atlas(std::exchange(other.m_atlas, nullptr))
+        , m_page(other.m_page)
+        , m_cell(other.m_cell)
+        , m_src_rect(other.m_src_rect) {}
+
+    atlas_image &atlas_image::operator = (atlas_image &&other) noexcept {
+        if (this != &other) {
+            reset();
+            m_atlas = std::exchange(other.m_atlas, nullptr);
+            m_page = other.m_page;
+            m_cell = other.m_cell;
+            m_src_rect = other.m_src_rect;
+        }
+        return *this;
+    }
+
+    void atlas_image::reset() {
+        if (m_atlas) {
+            m_atlas->release(m_page, m_cell);
+            m_atlas = nullptr;
+        }
+    }
+
+    sdl::texture_ref atlas_image::get_texture() const {
+        if (m_atlas) {
+            return m_atlas->m_pages[m_page].texture;
+        }
+        return nullptr;
+    }
+
+    // every cell keeps a transparent border of one pixel, so that linear filtering
+    // doesn't bleed the neighbouring images into the edges
+    static constexpr int cell_padding = 1;
+
+    texture_atlas::texture_atlas(sdl::renderer &renderer, int cell_width, int cell_height)
+        : m_renderer(renderer)
+        , m_cell_width(cell_width + cell_padding * 2)
+        , m_cell_height(cell_height + cell_padding * 2)
+        , m_columns(page_size / m_cell_width)
+        , m_cells_per_page(m_columns * (page_size / m_cell_height))
+    {
+        if (m_cells_per_page <= 0) {
+            throw sdl::error(fmt::format("Atlas cell too big: {}x{}", cell_width, cell_height));
+        }
+    }
+
+    sdl::rect texture_atlas::get_cell_rect(int cell) const {
+        return sdl::rect{
+            (cell % m_columns) * m_cell_width,
+            (cell / m_columns) * m_cell_height,
+            m_cell_width, m_cell_height
+        };
+    }
+
+    atlas_image texture_atlas::add(const sdl::surface &image) {
+        const sdl::rect image_rect = image.get_rect();
+        if (image_rect.w + cell_padding * 2 > m_cell_width || image_rect.h + cell_padding * 2 > m_cell_height) {
+            throw sdl::error(fmt::format("Image too big for atlas cell: {}x{}", image_rect.w, image_rect.h));
+        }
+
+        auto page_it = std::ranges::find_if(m_pages, [](const atlas_page &page) {
+            return !page.free_cells.empty();
+        });
+        if (page_it == m_pages.end()) {
+            m_pages.push_back(atlas_page{ sdl::texture(SDL_CreateTexture(m_renderer.get(),
+                SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, page_size, page_size)) });
+
+            atlas_page &page = m_pages.back();
+            SDL_SetTextureBlendMode(page.texture.get(), SDL_BLENDMODE_BLEND);
+
+            page.free_cells.resize(m_cells_per_page);
+            for (int i=0; i<m_cells_per_page; ++i) {
+                page.free_cells[i] = m_cells_per_page - i - 1;
+            }
+            page_it = m_pages.end() - 1;
+        }
+
+        atlas_image ret;
+        ret.m_atlas = this;
+        ret.m_page = int(page_it - m_pages.begin());
+        ret.m_cell = page_it->free_cells.back();
+        page_it->free_cells.pop_back();
+
+        // the whole cell is overwritten, clearing whatever the previous image left there
+        const sdl::rect cell_rect = get_cell_rect(ret.m_cell);
+        sdl::surface cell_surface(cell_rect.w, cell_rect.h);
+        SDL_FillRect(cell_surface.get(), nullptr, 0);
+
+        sdl::rect dst_rect{cell_padding, cell_padding, image_rect.w, image_rect.h};
+        SDL_SetSurfaceBlendMode(image.get(), SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(image.get(), nullptr, cell_surface.get(), &dst_rect);
+        SDL_SetSurfaceBlendMode(image.get(), SDL_BLENDMODE_BLEND);
+
+        SDL_UpdateTexture(page_it->texture.get(), &cell_rect, cell_surface.get()->pixels, cell_surface.get()->pitch);
+
+        ret.m_src_rect = sdl::rect{
+            cell_rect.x + cell_padding, cell_rect.y + cell_padding,
+            image_rect.w, image_rect.h
+        };
+        return ret;
+    }
+
+    void texture_atlas::release(int page, int cell) {
+        m_pages[page].free_cells.push_back(cell);
+    }
+
+    void render_batch::add(const atlas_image &image, const sdl::rect &dst_rect, const sdl::render_ex_options &options) {
+        if (!image) return;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        SDL_Texture *texture = image.get_texture().get();
+        if (texture != m_texture) {
+            flush();
+            m_texture = texture;
+        }
+
+        int tex_w, tex_h;
+        SDL_QueryTexture(texture, nullptr, nullptr, &tex_w, &tex_h);
+
+        const sdl::rect &src_rect = image.get_src_rect();
+        const float u0 = float(src_rect.x) / tex_w;
+        const float v0 = float(src_rect.y) / tex_h;
+        const float u1 = float(src_rect.x + src_rect.w) / tex_w;
+        const float v1 = float(src_rect.y + src_rect.h) / tex_h;
+
+        // same rotation as SDL_RenderCopyEx: clockwise in degrees, around the center of dst_rect
+        const float cx = dst_rect.x + dst_rect.w * .5f;
+        const float cy = dst_rect.y + dst_rect.h * .5f;
+        const float hw = dst_rect.w * .5f;
+        const float hh = dst_rect.h * .5f;
+        const float angle = float(options.angle * std::numbers::pi / 180.0);
+        const float cos_a = std::cos(angle);
+        const float sin_a = std::sin(angle);
+
+        auto make_vertex = [&](float dx, float dy, float u, float v) {
+            return SDL_Vertex{
+                SDL_FPoint{ cx + dx * cos_a - dy * sin_a, cy + dx * sin_a + dy * cos_a },
+                options.color_modifier,
+                SDL_FPoint{ u, v }
+            };
+        };
+
+        const int base = int(m_vertices.size());
+        m_vertices.push_back(make_vertex(-hw, -hh, u0, v0));
+        m_vertices.push_back(make_vertex( hw, -hh, u1, v0));
+        m_vertices.push_back(make_vertex( hw,  hh, u1, v1));
+        m_vertices.push_back(make_vertex(-hw,  hh, u0, v1));
+
+        for (int index : {0, 1, 2, 0, 2, 3}) {
+            m_indices.push_back(base + index);
+        }
+#else
+        SDL_Texture *texture = image.get_texture().get();
+        SDL_SetTextureColorMod(texture, options.color_modifier.r, options.color_modifier.g, options.color_modifier.b);
+        SDL_SetTextureAlphaMod(texture, options.color_modifier.a);
+        SDL_RenderCopyEx(m_renderer.get(), texture, &image.get_src_rect(), &dst_rect, options.angle, nullptr, SDL_FLIP_NONE);
+        SDL_SetTextureColorMod(texture, 0xff, 0xff, 0xff);
+        SDL_SetTextureAlphaMod(texture, 0xff);
+        ++s_draw_calls;
+#endif
+    }
+
+    void render_batch::flush() {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if (m_texture && !m_indices.empty()) {
+            SDL_RenderGeometry(m_renderer.get(), m_texture,
+                m_vertices.data(), int(m_vertices.size()),
+                m_indices.data(), int(m_indices.size()));
+            ++s_draw_calls;
+        }
+        m_vertices.clear();
+        m_indices.clear();
+#endif
+        m_texture = nullptr;
+    }
+
+}
\ No newline at end of file
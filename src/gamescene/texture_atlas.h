@@ -0,0 +1,131 @@
+#ifndef __TEXTURE_ATLAS_H__
+#define __TEXTURE_ATLAS_H__
+
+#include "sdl_wrap.h"
+
+#include <vector>
+
+namespace banggame {
+
+    class texture_atlas;
+
+    // A cell of a texture_atlas page, given back to the atlas when destroyed
+    class atlas_image {
+    public:
+        atlas_image() = default;
+        ~atlas_image();
+
+        atlas_image(const atlas_image &) = delete;
+        atlas_image(atlas_image &&other) noexcept;
+
+        atlas_image &operator = (const atlas_image &) = delete;
+        atlas_image &operator = (atlas_image &&other) noexcept;
+
+        void reset();
+
+        explicit operator bool() const {
+            return m_atlas != nullptr;
+        }
+
+        sdl::texture_ref get_texture() const;
+
+        const sdl::rect &get_src_rect() const {
+            return m_src_rect;
+        }
+
+        sdl::rect get_rect() const {
+            return sdl::rect{0, 0, m_src_rect.w, m_src_rect.h};
+        }
+
+        void render(sdl::renderer &renderer, const sdl::rect &rect) const {
+            SDL_RenderCopy(renderer.get(), get_texture().get(), &m_src_rect, &rect);
+        }
+
+    private:
+        friend class texture_atlas;
+
+        texture_atlas *m_atlas = nullptr;
+        int m_page = 0;
+        int m_cell = 0;
+        sdl::rect m_src_rect{};
+    };
+
+    // Packs same-sized images like card faces into a few big textures split in a grid of cells,
+    // so that everything drawn from the same page can be submitted with a single draw call
+    class texture_atlas {
+    public:
+        static constexpr int page_size = 2048;
+
+        texture_atlas(sdl::renderer &renderer, int cell_width, int cell_height);
+
+        texture_atlas(const texture_atlas &) = delete;
+        texture_atlas &operator = (const texture_atlas &) = delete;
+
+        atlas_image add(const sdl::surface &image);
+
+        size_t num_pages() const {
+            return m_pages.size();
+        }
+
+    private:
+        friend class atlas_image;
+
+        void release(int page, int cell);
+        sdl::rect get_cell_rect(int cell) const;
+
+        struct atlas_page {
+            sdl::texture texture;
+            std::vector<int> free_cells;
+        };
+
+        sdl::renderer &m_renderer;
+
+        int m_cell_width;
+        int m_cell_height;
+        int m_columns;
+        int m_cells_per_page;
+
+        std::vector<atlas_page> m_pages;
+    };
+
+    // Collects textured quads and submits all the consecutive ones drawn from the same texture
+    // with a single SDL_RenderGeometry call, flushing when the texture changes or when destroyed.
+    // With SDL older than 2.0.18 every quad is drawn right away with SDL_RenderCopyEx
+    class render_batch {
+    public:
+        explicit render_batch(sdl::renderer &renderer) : m_renderer(renderer) {}
+
+        ~render_batch() {
+            flush();
+        }
+
+        render_batch(const render_batch &) = delete;
+        render_batch &operator = (const render_batch &) = delete;
+
+        sdl::renderer &renderer() const {
+            return m_renderer;
+        }
+
+        void add(const atlas_image &image, const sdl::rect &dst_rect, const sdl::render_ex_options &options = {});
+
+        void flush();
+
+        static size_t draw_calls() {
+            return s_draw_calls;
+        }
+
+    private:
+        sdl::renderer &m_renderer;
+
+        SDL_Texture *m_texture = nullptr;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        std::vector<SDL_Vertex> m_vertices;
+        std::vector<int> m_indices;
+#endif
+
+        static inline size_t s_draw_calls = 0;
+    };
+
+}
+
+#endif
\ No newline at end of file
@@ -35,6 +35,9 @@ LOCALE_VALUE(CREATING_SERVER,                     "Creating Server...")
 LOCALE_VALUE(CONNECTING_TO,                       "Connecting to {} ...")
 LOCALE_VALUE(DIALOG_IMAGE_FILES,                  "Image Files")
 LOCALE_VALUE(DIALOG_ALL_FILES,                    "All Files")
+LOCALE_VALUE(REPLAYING_SESSION,                   "Replaying {} ...")
+LOCALE_VALUE(REPLAY_FINISHED,                     "Replay finished")
+LOCALE_VALUE(ERROR_RECORDING_SESSION,             "Could not record session: {}")
 
 LOCALE_VALUE(BUTTON_TOLOBBY,                      "Return To Lobby")
 
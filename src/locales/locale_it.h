@@ -35,6 +35,9 @@ LOCALE_VALUE(CREATING_SERVER,                     "Creazione del Server...")
 LOCALE_VALUE(CONNECTING_TO,                       "In connessione a {} ...")
 LOCALE_VALUE(DIALOG_IMAGE_FILES,                  "File Immagine")
 LOCALE_VALUE(DIALOG_ALL_FILES,                    "Tutti i File")
+LOCALE_VALUE(REPLAYING_SESSION,                   "Riproduzione di {} ...")
+LOCALE_VALUE(REPLAY_FINISHED,                     "Riproduzione terminata")
+LOCALE_VALUE(ERROR_RECORDING_SESSION,             "Impossibile registrare la sessione: {}")
 
 LOCALE_VALUE(BUTTON_TOLOBBY,                      "Torna a Lobby")
 
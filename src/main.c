@@ -9,6 +9,7 @@
 #endif
 
 BANGCLIENT_EXPORT long STDCALL entrypoint(const char *base_path);
+BANGCLIENT_EXPORT long STDCALL replay(const char *base_path, const char *replay_file, const char *mode);
 
 #define BUFFER_SIZE 256
 
@@ -23,5 +24,9 @@ int main(int argc, char **argv) {
         }
     }
     *(last_slash + 1) = '\0';
+
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+        return replay(base_path, argv[2], argc > 3 ? argv[3] : NULL);
+    }
     return entrypoint(base_path);
 }
\ No newline at end of file
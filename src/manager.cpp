@@ -8,6 +8,7 @@
 
 #include "media_pak.h"
 #include "os_api.h"
+#include "startup_trace.h"
 
 #include "scenes/connect.h"
 #include "scenes/loading.h"
@@ -16,25 +17,69 @@
 #include "gamescene/game.h"
 #include "net/git_version.h"
 
+#include <fmt/chrono.h>
+
 using namespace banggame;
 
 client_manager::client_manager(sdl::window &window, sdl::renderer &renderer, const std::filesystem::path &base_path)
+    : client_manager(window, renderer, base_path, load_config()) {}
+
+client_manager::client_manager(sdl::window &window, sdl::renderer &renderer, const std::filesystem::path &base_path, config &&loaded_config, bool save_config)
     : m_window(window)
     , m_renderer(renderer)
     , m_base_path(base_path)
+    , m_config(std::move(loaded_config))
+    , m_save_config(save_config)
 {
-    m_config.load();
+    startup_trace::span span{"connect_scene layout"};
     switch_scene<connect_scene>();
+    span.end();
+
+    if (m_config.network_thread) {
+        m_network_events = std::make_unique<spsc_queue<network_event, network_queue_size>>();
+        start_thread();
+    }
 }
 
 client_manager::~client_manager() {
     stop_listenserver();
-    m_config.save();
+    stop_thread();
+    if (m_save_config) {
+        m_config.save();
+    }
+}
+
+static std::filesystem::path get_session_log_path() {
+    auto path = std::filesystem::path(SDL_GetPrefPath(nullptr, "bang-sdl")) / "sessions";
+    std::filesystem::create_directories(path);
+    return path / fmt::format("{:%Y%m%d-%H%M%S}.banglog", fmt::localtime(std::time(nullptr)));
 }
 
 void client_manager::on_open() {
-    m_connection_open = true;
+    if (m_config.record_sessions) {
+        try {
+            m_recorder.emplace(get_session_log_path());
+        } catch (const std::exception &error) {
+            add_chat_message(message_type::error, _("ERROR_RECORDING_SESSION", error.what()));
+        }
+    }
+    post_event([this]{ handle_open(); });
+}
+
+void client_manager::on_close() {
+    m_recorder.reset();
+    post_event([this]{ handle_close(); });
+}
+
+void client_manager::on_message(const std::string &message) {
+    if (m_recorder) {
+        m_recorder->record(message);
+    }
+    post_event(parse_message(message));
+}
 
+void client_manager::handle_open() {
+    m_connection_open = true;
     m_accept_timer = accept_timeout;
 
     add_message<banggame::client_message_type::connect>(
@@ -49,7 +94,7 @@ void client_manager::on_open() {
         );
 }
 
-void client_manager::on_close() {
+void client_manager::handle_close() {
     if (!m_connection_closed.exchange(true)) {
         switch_scene<connect_scene>();
     }
@@ -59,26 +104,54 @@ void client_manager::on_close() {
     m_accept_timer.reset();
 }
 
-void client_manager::on_message(const std::string &message) {
+client_manager::network_event client_manager::parse_message(const std::string &message) {
     try {
-        auto server_msg = json::deserialize<server_message>(json::json::parse(message));
-        try {
-            enums::visit_indexed([&]<server_message_type E>(enums::enum_tag_t<E> tag, auto && ... args) {
-                if constexpr (requires { handle_message(tag, args...); }) {
-                    handle_message(tag, args...);
-                }
-                if (auto handler = dynamic_cast<message_handler<E> *>(m_scene.get())) {
-                    handler->handle_message(tag, args...);
-                } 
-            }, server_msg);
-        } catch (const std::exception &error) {
-            add_chat_message(message_type::error, fmt::format("Error: {}", error.what()));
-        }
+        return json::deserialize<server_message>(json::json::parse(message));
     } catch (const std::exception &) {
-        disconnect();
+        return [this]{ disconnect(); };
+    }
+}
+
+void client_manager::post_event(network_event event) {
+    if (!is_threaded()) {
+        dispatch_event(std::move(event));
+        return;
+    }
+    // the network thread waits for the main thread to catch up instead of dropping messages
+    while (!m_network_events->push(std::move(event))) {
+        if (stopped()) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    if (!m_wake_pending.exchange(true)) {
+        SDL_Event wake_event{};
+        wake_event.type = network_wake_event();
+        SDL_PushEvent(&wake_event);
     }
 }
 
+void client_manager::dispatch_event(network_event event) {
+    std::visit(overloaded{
+        [](std::function<void()> &fun) {
+            fun();
+        },
+        [&](server_message &server_msg) {
+            try {
+                enums::visit_indexed([&]<server_message_type E>(enums::enum_tag_t<E> tag, auto && ... args) {
+                    if constexpr (requires { handle_message(tag, args...); }) {
+                        handle_message(tag, args...);
+                    }
+                    if (auto handler = dynamic_cast<message_handler<E> *>(m_scene.get())) {
+                        handler->handle_message(tag, std::move(args)...);
+                    }
+                }, server_msg);
+            } catch (const std::exception &error) {
+                add_chat_message(message_type::error, fmt::format("Error: {}", error.what()));
+            }
+        }
+    }, event);
+    invalidate();
+}
+
 void client_manager::connect(const std::string &host) {
     if (host.empty()) {
         add_chat_message(message_type::error, _("ERROR_NO_ADDRESS"));
@@ -92,9 +165,42 @@ void client_manager::connect(const std::string &host) {
 void client_manager::disconnect() {
     stop_listenserver();
     net::wsconnection::disconnect();
+    if (m_replay) {
+        m_replay.reset();
+        handle_close();
+    }
+}
+
+void client_manager::start_replay(const std::filesystem::path &path, replay_mode mode) {
+    try {
+        m_replay.emplace(path, mode);
+        m_connection_closed = false;
+        m_connection_open = true;
+        switch_scene<loading_scene>(_("REPLAYING_SESSION", path.filename().string()));
+    } catch (const std::exception &error) {
+        add_chat_message(message_type::error, error.what());
+    }
+}
+
+sdl::texture make_background_texture(sdl::renderer &renderer, sdl::texture_ref tile, const sdl::rect &rect) {
+    if (!SDL_RenderTargetSupported(renderer.get()) || rect.w <= 0 || rect.h <= 0) {
+        return {};
+    }
+    sdl::texture ret = SDL_CreateTexture(renderer.get(), SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, rect.w, rect.h);
+    SDL_SetTextureBlendMode(ret.get(), SDL_BLENDMODE_NONE);
+    {
+        sdl::render_target_guard guard{renderer, ret};
+        sdl::render_tiled(renderer, tile, rect);
+    }
+    return ret;
 }
 
 void client_manager::refresh_layout() {
+    const sdl::rect win_rect = get_rect();
+    if (sdl::rect bg_rect = m_background.get_rect(); bg_rect.w != win_rect.w || bg_rect.h != win_rect.h) {
+        m_background = make_background_texture(m_renderer, media_pak::get().texture_background, win_rect);
+    }
+
     m_scene->refresh_layout();
 
     m_chat.set_rect(sdl::rect{
@@ -103,28 +209,37 @@ void client_manager::refresh_layout() {
         240,
         350
     });
+
+    invalidate();
 }
 
-static void render_tiled(sdl::renderer &renderer, sdl::texture_ref texture, const sdl::rect &dst_rect) {
-    const sdl::rect src_rect = texture.get_rect();
+void client_manager::tick(duration_type time_elapsed) {
+    // also redraw the frame in which the animation ends
+    if (is_animating()) {
+        invalidate();
+    }
 
-    for (int y=dst_rect.y; y<=dst_rect.w + dst_rect.h + src_rect.h; y+=src_rect.h) {
-        for (int x=dst_rect.x; x<=dst_rect.x + dst_rect.w + src_rect.w; x+=src_rect.w) {
-            sdl::rect from = src_rect;
-            sdl::rect to{x, y, src_rect.w, src_rect.h};
-            if (to.x + to.w > dst_rect.x + dst_rect.w) {
-                from.w = to.w = dst_rect.x + dst_rect.w - to.x;
-            }
-            if (to.y + to.h > dst_rect.y + dst_rect.h) {
-                from.h = to.h = dst_rect.y + dst_rect.h - to.y;
-            }
-            SDL_RenderCopy(renderer.get(), texture.get(), &from, &to);
+    poll();
+
+    if (m_network_events) {
+        m_wake_pending = false;
+        while (auto event = m_network_events->pop()) {
+            dispatch_event(std::move(*event));
         }
     }
-}
 
-void client_manager::tick(duration_type time_elapsed) {
-    poll();
+    if (m_replay) {
+        m_replay->advance(time_elapsed);
+        while (m_replay) {
+            auto message = m_replay->next_message();
+            if (!message) break;
+            dispatch_event(parse_message(*message));
+        }
+        if (m_replay && m_replay->finished()) {
+            m_replay.reset();
+            add_chat_message(message_type::server_log, _("REPLAY_FINISHED"));
+        }
+    }
     
     if (m_accept_timer && (*m_accept_timer -= time_elapsed) <= duration_type{}) {
         add_chat_message(message_type::error, _("ACCEPT_TIMEOUT_EXPIRED"));
@@ -136,16 +251,59 @@ void client_manager::tick(duration_type time_elapsed) {
 }
 
 void client_manager::render(sdl::renderer &renderer) {
-    render_tiled(renderer, media_pak::get().texture_background, sdl::rect{0, 0, width(), height()});
+    const sdl::rect win_rect = get_rect();
+
+    std::optional<sdl::rect> damaged = widgets::damage::take();
+    if (m_needs_redraw.exchange(false)) {
+        damaged = win_rect;
+    }
+
+    if (!SDL_RenderTargetSupported(renderer.get())) {
+        render_frame(renderer);
+        return;
+    }
+
+    if (sdl::rect frame_rect = m_frame.get_rect(); frame_rect.w != win_rect.w || frame_rect.h != win_rect.h) {
+        m_frame = SDL_CreateTexture(renderer.get(), SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, win_rect.w, win_rect.h);
+        SDL_SetTextureBlendMode(m_frame.get(), SDL_BLENDMODE_NONE);
+        damaged = win_rect;
+    }
+
+    if (damaged && SDL_IntersectRect(&*damaged, &win_rect, &*damaged)) {
+        sdl::render_target_guard guard{renderer, m_frame};
+        SDL_RenderSetClipRect(renderer.get(), &*damaged);
+        render_frame(renderer);
+    }
+
+    m_frame.render(renderer, win_rect);
+}
+
+void client_manager::render_frame(sdl::renderer &renderer) {
+    if (m_background) {
+        m_background.render(renderer, m_background.get_rect());
+    } else {
+        sdl::render_tiled(renderer, media_pak::get().texture_background, get_rect());
+    }
     
     m_scene->render(renderer);
     m_chat.render(renderer);
 }
 
 void client_manager::handle_event(const sdl::event &event) {
+    // pointer motion only changes hovered widgets, which report their own damage.
+    // Any other event can trigger callbacks that change the whole screen
+    if (event.type != SDL_MOUSEMOTION) {
+        invalidate();
+    }
+
     if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_RETURN && bool(event.key.keysym.mod & KMOD_ALT)) {
         Uint32 fullscreen = SDL_WINDOW_FULLSCREEN_DESKTOP;
         SDL_SetWindowFullscreen(m_window.get(), SDL_GetWindowFlags(m_window.get()) & fullscreen ? 0 : fullscreen);
+    } else if (event.type == SDL_RENDER_TARGETS_RESET) {
+        m_background.reset();
+        refresh_layout();
+    } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F10 && m_replay && m_replay->mode() == replay_mode::single_step) {
+        m_replay->step();
     } else if (!widgets::event_handler::handle_events(event)) {
         m_scene->handle_event(event);
     }
@@ -157,6 +315,7 @@ void client_manager::enable_chat() {
 
 void client_manager::add_chat_message(message_type type, const std::string &message) {
     m_chat.add_message(type, message);
+    invalidate();
 }
 
 std::filesystem::path client_manager::get_listenserver_path() const {
@@ -232,8 +391,10 @@ void client_manager::start_listenserver() {
     m_listenserver_thread = std::thread([&]{
         m_listenserver->get_exit_status();
         asio::post(get_executor(), [&]{
-            m_listenserver.reset();
-            on_close();
+            post_event([&]{
+                m_listenserver.reset();
+                handle_close();
+            });
         });
     });
 }
@@ -329,7 +490,11 @@ void client_manager::handle_message(SRV_TAG(lobby_chat), const lobby_chat_args &
 }
 
 void client_manager::handle_message(SRV_TAG(game_started)) {
-    switch_scene<banggame::game_scene>();
+    if (auto *lobby = dynamic_cast<lobby_scene *>(m_scene.get())) {
+        switch_scene<banggame::game_scene>(lobby->get_lobby_options());
+    } else {
+        switch_scene<banggame::game_scene>();
+    }
 }
 
 sdl::texture client_manager::browse_propic() {
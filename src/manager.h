@@ -1,6 +1,7 @@
 #ifndef __CLIENT_MANAGER_H__
 #define __CLIENT_MANAGER_H__
 
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -12,6 +13,8 @@
 #include "chat_ui.h"
 #include "image_serial.h"
 #include "wsconnection.h"
+#include "session_log.h"
+#include "spsc_queue.h"
 
 #include "net/messages.h"
 
@@ -20,9 +23,18 @@
 static constexpr std::chrono::seconds accept_timeout{5};
 
 using id_user_info_pair = std::pair<int, banggame::user_info>;
+
+// the background tiles composed once into a texture of the given size,
+// empty if the renderer doesn't support render targets
+sdl::texture make_background_texture(sdl::renderer &renderer, sdl::texture_ref tile, const sdl::rect &rect);
+
 class client_manager : private net::wsconnection {
 public:
     client_manager(sdl::window &window, sdl::renderer &renderer, const std::filesystem::path &base_path);
+
+    // with a config already loaded, as done on a worker thread at startup.
+    // The benchmarks pass save_config = false so that they never overwrite the user's settings
+    client_manager(sdl::window &window, sdl::renderer &renderer, const std::filesystem::path &base_path, config &&loaded_config, bool save_config = true);
     ~client_manager();
 
     void refresh_layout();
@@ -30,8 +42,27 @@ public:
     void tick(duration_type time_elapsed);
     void render(sdl::renderer &renderer);
 
+    bool is_animating() const {
+        return m_scene->is_animating();
+    }
+
+    bool needs_redraw() const {
+        return m_needs_redraw || !widgets::damage::empty();
+    }
+
+    void invalidate() {
+        m_needs_redraw = true;
+    }
+
     void handle_event(const sdl::event &event);
 
+    // pushed by the network thread when it queues a message, so that the main loop
+    // stops waiting for input and dispatches it on the next tick
+    static Uint32 network_wake_event() {
+        static const Uint32 type = SDL_RegisterEvents(1);
+        return type;
+    }
+
     template<banggame::client_message_type E>
     void add_message(auto && ... args) {
         push_message(json::serialize(banggame::client_message{enums::enum_tag<E>, FWD(args) ...}).dump());
@@ -40,6 +71,8 @@ public:
     void connect(const std::string &host);
     void disconnect();
 
+    void start_replay(const std::filesystem::path &path, replay_mode mode);
+
     template<std::derived_from<scene_base> T>
     void switch_scene(auto && ... args) {
         m_chat.disable();
@@ -47,6 +80,10 @@ public:
         refresh_layout();
     }
 
+    scene_base *get_scene() const {
+        return m_scene.get();
+    }
+
     config &get_config() {
         return m_config;
     }
@@ -106,6 +143,21 @@ protected:
     void on_message(const std::string &msg) override;
 
 private:
+    void render_frame(sdl::renderer &renderer);
+
+    // in threaded mode the connection callbacks run on the network thread:
+    // messages are decoded there, and everything else is deferred to tick()
+    using network_event = std::variant<std::function<void()>, banggame::server_message>;
+
+    static constexpr size_t network_queue_size = 1024;
+
+    network_event parse_message(const std::string &message);
+    void post_event(network_event event);
+    void dispatch_event(network_event event);
+
+    void handle_open();
+    void handle_close();
+
     void handle_message(SRV_TAG(ping));
     void handle_message(SRV_TAG(lobby_error), const std::string &message);
     void handle_message(SRV_TAG(lobby_owner), const banggame::user_id_args &args);
@@ -123,6 +175,7 @@ private:
 
     std::filesystem::path m_base_path;
     config m_config;
+    bool m_save_config;
 
     std::unique_ptr<scene_base> m_scene;
 
@@ -130,12 +183,27 @@ private:
 
     int m_lobby_owner_id = 0;
 
+    std::atomic<bool> m_needs_redraw = true;
+
+    // the last rendered frame, only the damaged area is redrawn on top of it
+    sdl::texture m_frame;
+    sdl::texture m_background;
+
 private:
     std::atomic<bool> m_connection_open = false;
     std::atomic<bool> m_connection_closed = false;
 
     std::optional<duration_type> m_accept_timer;
 
+    std::optional<session_recorder> m_recorder;
+    std::optional<session_replayer> m_replay;
+
+    // only allocated when the network thread is started
+    std::unique_ptr<spsc_queue<network_event, network_queue_size>> m_network_events;
+
+    // set while a wake event is in the SDL queue, so a burst of messages pushes only one
+    std::atomic<bool> m_wake_pending = false;
+
     std::unique_ptr<TinyProcessLib::Process> m_listenserver;
     std::thread m_listenserver_thread;
 
@@ -1,36 +1,56 @@
 #include "media_pak.h"
 
-#include "utils/unpacker.h"
+#include "startup_trace.h"
 
-media_pak::media_pak(const std::filesystem::path &base_path, sdl::renderer &renderer) {
-    auto media_pak_stream = ifstream_or_throw(base_path / "media.pak");
-    unpacker media_pak(media_pak_stream);
+static constexpr std::pair<sdl::texture media_pak::*, std::string_view> media_textures[] = {
+    {&media_pak::texture_background,    "background"},
 
-    icon_bang = sdl::surface(media_pak["icon_bang"]);
+    {&media_pak::icon_checkbox,         "icon_checkbox"},
+    {&media_pak::icon_default_user,     "icon_default_user"},
+    {&media_pak::icon_disconnected,     "icon_disconnected"},
+    {&media_pak::icon_loading,          "icon_loading"},
+    {&media_pak::icon_owner,            "icon_owner"},
 
-    font_arial =            media_pak["fonts/arial"];
-    font_perdido =          media_pak["fonts/perdido"];
-    font_bkant_bold =       media_pak["fonts/bkant_bold"];
+    {&media_pak::icon_turn,             "icon_turn"},
+    {&media_pak::icon_origin,           "icon_origin"},
+    {&media_pak::icon_target,           "icon_target"},
+    {&media_pak::icon_winner,           "icon_winner"},
 
-    texture_background =    sdl::texture(renderer, media_pak["background"]);
+    {&media_pak::icon_dead_players,     "icon_dead_players"},
 
-    icon_checkbox =         sdl::texture(renderer, media_pak["icon_checkbox"]);
-    icon_default_user =     sdl::texture(renderer, media_pak["icon_default_user"]);
-    icon_disconnected =     sdl::texture(renderer, media_pak["icon_disconnected"]);
-    icon_loading =          sdl::texture(renderer, media_pak["icon_loading"]);
-    icon_owner =            sdl::texture(renderer, media_pak["icon_owner"]);
+    {&media_pak::icon_gold,             "icon_gold"},
+};
 
-    icon_turn =             sdl::texture(renderer, media_pak["icon_turn"]);
-    icon_origin =           sdl::texture(renderer, media_pak["icon_origin"]);
-    icon_target =           sdl::texture(renderer, media_pak["icon_target"]);
-    icon_winner =           sdl::texture(renderer, media_pak["icon_winner"]);
+media_pak::media_pak(const std::filesystem::path &base_path)
+    : m_pak(base_path / "media.pak")
+{
+    startup_trace::span span{"media_pak decode"};
 
-    icon_dead_players =     sdl::texture(renderer, media_pak["icon_dead_players"]);
+    icon_bang = sdl::surface(m_pak["icon_bang"]);
 
-    icon_gold =             sdl::texture(renderer, media_pak["icon_gold"]);
+    font_arial =            m_pak["fonts/arial"];
+    font_perdido =          m_pak["fonts/perdido"];
+    font_bkant_bold =       m_pak["fonts/bkant_bold"];
 
-    sprite_cube =           sdl::texture(renderer, media_pak["sprite_cube"]);
-    sprite_cube_border =    sdl::texture(renderer, media_pak["sprite_cube_border"]);
+    for (const auto &[texture, name] : media_textures) {
+        m_pending_textures.emplace_back(texture, sdl::surface(m_pak[name]));
+    }
+
+    sprite_cube =           sdl::surface(m_pak["sprite_cube"]);
+    sprite_cube_border =    sdl::surface(m_pak["sprite_cube_border"]);
 
     s_instance = this;
+}
+
+media_pak::media_pak(const std::filesystem::path &base_path, sdl::renderer &renderer)
+    : media_pak(base_path)
+{
+    upload_textures(renderer);
+}
+
+void media_pak::upload_textures(sdl::renderer &renderer) {
+    for (auto &[texture, surface] : m_pending_textures) {
+        this->*texture = sdl::texture(renderer, surface);
+    }
+    m_pending_textures.clear();
 }
\ No newline at end of file
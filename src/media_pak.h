@@ -2,9 +2,11 @@
 #define __MEDIA_PAK_H__
 
 #include "sdl_wrap.h"
-#include "utils/resource.h"
+#include "pak_file.h"
 
 #include <filesystem>
+#include <utility>
+#include <vector>
 
 class media_pak {
 public:
@@ -27,21 +29,35 @@ public:
 
     sdl::texture icon_gold;
 
-    sdl::texture sprite_cube;
-    sdl::texture sprite_cube_border;
+    sdl::surface sprite_cube;
+    sdl::surface sprite_cube_border;
 
-    resource font_arial;
-    resource font_perdido;
-    resource font_bkant_bold;
+    resource_view font_arial;
+    resource_view font_perdido;
+    resource_view font_bkant_bold;
 
     static const media_pak &get() {
         return *s_instance;
     }
 
 public:
+    // maps the pak and decodes the images, which can be done on a worker thread
+    explicit media_pak(const std::filesystem::path &base_path);
+
     media_pak(const std::filesystem::path &base_path, sdl::renderer &renderer);
 
+    media_pak(const media_pak &) = delete;
+    media_pak &operator = (const media_pak &) = delete;
+
+    // creates the textures from the decoded images, on the thread that owns the renderer
+    void upload_textures(sdl::renderer &renderer);
+
 private:
+    // fonts are read lazily by SDL_ttf straight from the mapping
+    pak_file m_pak;
+
+    std::vector<std::pair<sdl::texture media_pak::*, sdl::surface>> m_pending_textures;
+
     static inline media_pak *s_instance = nullptr;
 };
 
@@ -0,0 +1,459 @@
+#include "pak_file.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifdef HAVE_ZSTD
+    #include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4
+    #include <lz4.h>
+#endif
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+mapped_file::mapped_file(const std::filesystem::path &path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error(fmt::format("Could not open {}", path.string()));
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        throw std::runtime_error(fmt::format("Could not read size of {}", path.string()));
+    }
+    m_size = size_t(file_size.QuadPart);
+
+    if (m_size != 0) {
+        m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping) {
+            m_data = static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+    }
+    CloseHandle(file);
+
+    if (m_size != 0 && !m_data) {
+        reset();
+        throw std::runtime_error(fmt::format("Could not map {}", path.string()));
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(fmt::format("Could not open {}", path.string()));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        throw std::runtime_error(fmt::format("Could not read size of {}", path.string()));
+    }
+    m_size = size_t(st.st_size);
+
+    if (m_size != 0) {
+        void *ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error(fmt::format("Could not map {}", path.string()));
+        }
+        m_data = static_cast<const char *>(ptr);
+    }
+    close(fd);
+#endif
+}
+
+mapped_file::mapped_file(mapped_file &&other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+#ifdef _WIN32
+    , m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+{}
+
+mapped_file &mapped_file::operator = (mapped_file &&other) noexcept {
+    if (this != &other) {
+        reset();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+mapped_file::~mapped_file() {
+    reset();
+}
+
+void mapped_file::reset() {
+#ifdef _WIN32
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+#else
+    if (m_data) {
+        munmap(const_cast<char *>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+// Both formats store all integers in little endian.
+//
+// Version 1 starts with the number of entries, then for each entry the length of its name,
+// the name, the offset of its data relative to the end of the directory and its size.
+//
+// Version 2 starts with pak_magic, the number of entries and the size of the name table.
+// The directory follows, sorted by the FNV-1a hash of the names, with 48 byte records:
+// name hash, content hash, absolute offset, stored size, uncompressed size (all u64),
+// name offset in the name table (u32), name length (u16) and flags (u16).
+// Then comes the name table, and the payloads each aligned to pak_alignment bytes.
+static constexpr std::string_view pak_magic{"BANGPAK\x02", 8};
+static constexpr size_t pak_alignment = 64;
+
+enum pak_entry_flags : uint32_t {
+    pak_compressed_zstd = 1 << 0,
+    pak_compressed_lz4 = 1 << 1,
+};
+
+class pak_directory_reader {
+public:
+    pak_directory_reader(const mapped_file &file, const std::filesystem::path &path)
+        : m_file(file), m_path(path) {}
+
+    template<std::unsigned_integral T>
+    T read_int() {
+        const char *bytes = read_bytes(sizeof(T));
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            value |= T(static_cast<uint8_t>(bytes[i])) << (i * 8);
+        }
+        return value;
+    }
+
+    uint64_t read_u64() {
+        return read_int<uint64_t>();
+    }
+
+    std::string_view read_string(uint64_t length) {
+        return {read_bytes(length), size_t(length)};
+    }
+
+    // returns a view of the bytes in [offset, offset + length) of the whole file
+    resource_view get_range(uint64_t offset, uint64_t length) const {
+        if (offset > m_file.size() || length > m_file.size() - offset) {
+            invalid();
+        }
+        return resource_view{m_file.data() + offset, size_t(length)};
+    }
+
+    size_t offset() const {
+        return m_offset;
+    }
+
+    [[noreturn]] void invalid() const {
+        throw std::runtime_error(fmt::format("{} is not a valid pak file", m_path.string()));
+    }
+
+private:
+    const char *read_bytes(uint64_t length) {
+        if (length > m_file.size() - m_offset) {
+            invalid();
+        }
+        const char *ret = m_file.data() + m_offset;
+        m_offset += size_t(length);
+        return ret;
+    }
+
+    const mapped_file &m_file;
+    const std::filesystem::path &m_path;
+    size_t m_offset = 0;
+};
+
+pak_file::pak_file(const std::filesystem::path &path)
+    : m_file(path)
+{
+    constexpr auto entry_less = [](const pak_entry &lhs, const pak_entry &rhs) {
+        return std::tie(lhs.name_hash, lhs.name) < std::tie(rhs.name_hash, rhs.name);
+    };
+
+    if (std::string_view(m_file.data(), std::min(m_file.size(), pak_magic.size())) == pak_magic) {
+        read_directory_v2(path);
+        if (!std::ranges::is_sorted(m_entries, entry_less)) {
+            throw std::runtime_error(fmt::format("{} is not a valid pak file", path.string()));
+        }
+    } else {
+        read_directory_v1(path);
+        std::ranges::sort(m_entries, entry_less);
+    }
+}
+
+void pak_file::read_directory_v1(const std::filesystem::path &path) {
+    pak_directory_reader reader(m_file, path);
+
+    struct directory_entry {
+        std::string_view name;
+        uint64_t begin;
+        uint64_t size;
+    };
+
+    std::vector<directory_entry> directory;
+    uint64_t num_entries = reader.read_u64();
+    for (uint64_t i = 0; i < num_entries; ++i) {
+        auto &entry = directory.emplace_back();
+        entry.name = reader.read_string(reader.read_u64());
+        entry.begin = reader.read_u64();
+        entry.size = reader.read_u64();
+    }
+
+    const size_t data_begin = reader.offset();
+    const size_t data_size = m_file.size() - data_begin;
+
+    m_version = 1;
+    m_entries.reserve(directory.size());
+    for (const directory_entry &entry : directory) {
+        if (entry.begin > data_size) {
+            reader.invalid();
+        }
+        m_entries.push_back(pak_entry{
+            .name_hash = fnv1a_hash(entry.name),
+            .name = entry.name,
+            .data = reader.get_range(data_begin + entry.begin, entry.size),
+            .size = size_t(entry.size),
+            .content_hash = 0,
+            .flags = 0
+        });
+    }
+}
+
+void pak_file::read_directory_v2(const std::filesystem::path &path) {
+    pak_directory_reader reader(m_file, path);
+    reader.read_string(pak_magic.size());
+
+    uint64_t num_entries = reader.read_u64();
+    uint64_t names_size = reader.read_u64();
+
+    constexpr size_t record_size = 48;
+    if (num_entries > (m_file.size() - reader.offset()) / record_size) {
+        reader.invalid();
+    }
+    const resource_view names = reader.get_range(reader.offset() + num_entries * record_size, names_size);
+
+    m_version = 2;
+    m_entries.reserve(num_entries);
+    for (uint64_t i = 0; i < num_entries; ++i) {
+        auto &entry = m_entries.emplace_back();
+        entry.name_hash = reader.read_u64();
+        entry.content_hash = reader.read_u64();
+        uint64_t offset = reader.read_u64();
+        uint64_t stored_size = reader.read_u64();
+        entry.size = size_t(reader.read_u64());
+        uint32_t name_offset = reader.read_int<uint32_t>();
+        uint16_t name_length = reader.read_int<uint16_t>();
+        entry.flags = reader.read_int<uint16_t>();
+
+        if (name_offset > names.length || name_length > names.length - name_offset) {
+            reader.invalid();
+        }
+        entry.name = std::string_view(names.data + name_offset, name_length);
+        if (entry.name_hash != fnv1a_hash(entry.name) || offset % pak_alignment != 0) {
+            reader.invalid();
+        }
+        entry.data = reader.get_range(offset, stored_size);
+        if (entry.flags == 0 && stored_size != entry.size) {
+            reader.invalid();
+        }
+    }
+}
+
+const pak_file::pak_entry *pak_file::find_entry(std::string_view name) const {
+    const uint64_t hash = fnv1a_hash(name);
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), std::tie(hash, name), [](const pak_entry &entry, const auto &key) {
+        return std::tie(entry.name_hash, entry.name) < key;
+    });
+    if (it != m_entries.end() && it->name_hash == hash && it->name == name) {
+        return &*it;
+    }
+    return nullptr;
+}
+
+// BLAKE2b with an 8 byte digest and no key, as hashlib.blake2b(data, digest_size=8) in pack.py
+static uint64_t blake2b_64(const char *data, size_t length) {
+    static constexpr uint64_t iv[8] = {
+        0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+        0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179,
+    };
+    static constexpr uint8_t sigma[12][16] = {
+        { 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15},
+        {14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3},
+        {11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4},
+        { 7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8},
+        { 9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13},
+        { 2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9},
+        {12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11},
+        {13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10},
+        { 6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5},
+        {10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0},
+        { 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15},
+        {14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3},
+    };
+
+    constexpr auto rotr = [](uint64_t x, int n) { return (x >> n) | (x << (64 - n)); };
+
+    uint64_t h[8];
+    std::copy(std::begin(iv), std::end(iv), h);
+    h[0] ^= 0x01010000 | 8;
+
+    auto compress = [&](const uint8_t *block, uint64_t counter, bool last) {
+        uint64_t m[16];
+        for (int i = 0; i < 16; ++i) {
+            m[i] = 0;
+            for (int j = 0; j < 8; ++j) {
+                m[i] |= uint64_t(block[i * 8 + j]) << (j * 8);
+            }
+        }
+
+        uint64_t v[16];
+        std::copy(h, h + 8, v);
+        std::copy(std::begin(iv), std::end(iv), v + 8);
+        v[12] ^= counter;
+        if (last) {
+            v[14] = ~v[14];
+        }
+
+        auto mix = [&](int a, int b, int c, int d, uint64_t x, uint64_t y) {
+            v[a] = v[a] + v[b] + x; v[d] = rotr(v[d] ^ v[a], 32);
+            v[c] = v[c] + v[d];     v[b] = rotr(v[b] ^ v[c], 24);
+            v[a] = v[a] + v[b] + y; v[d] = rotr(v[d] ^ v[a], 16);
+            v[c] = v[c] + v[d];     v[b] = rotr(v[b] ^ v[c], 63);
+        };
+
+        for (const auto &s : sigma) {
+            mix(0, 4,  8, 12, m[s[ 0]], m[s[ 1]]);
+            mix(1, 5,  9, 13, m[s[ 2]], m[s[ 3]]);
+            mix(2, 6, 10, 14, m[s[ 4]], m[s[ 5]]);
+            mix(3, 7, 11, 15, m[s[ 6]], m[s[ 7]]);
+            mix(0, 5, 10, 15, m[s[ 8]], m[s[ 9]]);
+            mix(1, 6, 11, 12, m[s[10]], m[s[11]]);
+            mix(2, 7,  8, 13, m[s[12]], m[s[13]]);
+            mix(3, 4,  9, 14, m[s[14]], m[s[15]]);
+        }
+
+        for (int i = 0; i < 8; ++i) {
+            h[i] ^= v[i] ^ v[i + 8];
+        }
+    };
+
+    // the last block is always compressed with the final flag, even when it's full
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+    uint64_t counter = 0;
+    while (length > 128) {
+        counter += 128;
+        compress(bytes, counter, false);
+        bytes += 128;
+        length -= 128;
+    }
+
+    uint8_t last_block[128] = {};
+    std::copy(bytes, bytes + length, last_block);
+    compress(last_block, counter + length, true);
+
+    // the digest is the first 8 bytes of the state, read as little endian by pack.py
+    return h[0];
+}
+
+static std::vector<char> decompress_entry(std::string_view name, resource_view data, size_t size, uint32_t flags) {
+    std::vector<char> ret(size);
+    if (flags & pak_compressed_zstd) {
+#ifdef HAVE_ZSTD
+        size_t result = ZSTD_decompress(ret.data(), ret.size(), data.data, data.length);
+        if (ZSTD_isError(result) || result != size) {
+            throw std::runtime_error(fmt::format("Could not decompress {}", name));
+        }
+        return ret;
+#endif
+    } else if (flags & pak_compressed_lz4) {
+#ifdef HAVE_LZ4
+        int result = LZ4_decompress_safe(data.data, ret.data(), int(data.length), int(size));
+        if (result < 0 || size_t(result) != size) {
+            throw std::runtime_error(fmt::format("Could not decompress {}", name));
+        }
+        return ret;
+#endif
+    }
+    throw std::runtime_error(fmt::format("Unsupported compression for {}", name));
+}
+
+std::vector<char> pak_file::decompress_verified(const pak_entry &entry) {
+    std::vector<char> contents = decompress_entry(entry.name, entry.data, entry.size, entry.flags);
+    if (blake2b_64(contents.data(), contents.size()) != entry.content_hash) {
+        throw std::runtime_error(fmt::format("Corrupted entry {}", entry.name));
+    }
+    return contents;
+}
+
+resource_view pak_file::operator[](std::string_view name) const {
+    const pak_entry *entry = find_entry(name);
+    if (!entry) {
+        throw std::out_of_range(fmt::format("Cannot find {}", name));
+    }
+    if (entry->flags == 0) {
+        return entry->data;
+    }
+
+    std::scoped_lock lock{m_decompressed_mutex};
+    auto it = m_decompressed.find(entry->name);
+    if (it == m_decompressed.end()) {
+        it = m_decompressed.emplace_hint(it, entry->name, decompress_verified(*entry));
+    }
+    return resource_view{it->second.data(), it->second.size()};
+}
+
+std::vector<char> pak_file::read(std::string_view name) const {
+    const pak_entry *entry = find_entry(name);
+    if (!entry) {
+        throw std::out_of_range(fmt::format("Cannot find {}", name));
+    }
+    if (entry->flags == 0) {
+        return std::vector<char>(entry->data.data, entry->data.data + entry->data.length);
+    }
+    return decompress_verified(*entry);
+}
+
+std::vector<std::string_view> pak_file::names() const {
+    std::vector<std::string_view> ret;
+    ret.reserve(m_entries.size());
+    for (const pak_entry &entry : m_entries) {
+        ret.push_back(entry.name);
+    }
+    return ret;
+}
+
+uint64_t pak_file::content_hash(std::string_view name) const {
+    if (const pak_entry *entry = find_entry(name)) {
+        return entry->content_hash;
+    }
+    throw std::out_of_range(fmt::format("Cannot find {}", name));
+}
\ No newline at end of file
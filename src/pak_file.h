@@ -0,0 +1,112 @@
+#ifndef __PAK_FILE_H__
+#define __PAK_FILE_H__
+
+#include "utils/resource.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only memory mapping of a whole file
+class mapped_file {
+public:
+    mapped_file() = default;
+    explicit mapped_file(const std::filesystem::path &path);
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file(mapped_file &&other) noexcept;
+
+    mapped_file &operator = (const mapped_file &) = delete;
+    mapped_file &operator = (mapped_file &&other) noexcept;
+
+    ~mapped_file();
+
+    const char *data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+private:
+    void reset();
+
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+
+#ifdef _WIN32
+    void *m_mapping = nullptr;
+#endif
+};
+
+// hash of the entry names, the v2 directory is sorted by it
+constexpr uint64_t fnv1a_hash(std::string_view str) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (char c : str) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+// Pak written by resources/pack.py, either in the original linear format or in the indexed v2 format.
+// Uncompressed entries are returned as views directly into the mapping, compressed entries
+// are decompressed and verified once on first access. Views stay valid as long as the pak_file is alive
+class pak_file {
+public:
+    explicit pak_file(const std::filesystem::path &path);
+
+    bool contains(std::string_view name) const {
+        return find_entry(name) != nullptr;
+    }
+
+    resource_view operator[](std::string_view name) const;
+
+    // copy of the contents owned by the caller. Compressed entries are decompressed and verified
+    // every time and are not kept in the pak_file, for entries only read once
+    std::vector<char> read(std::string_view name) const;
+
+    // BLAKE2b hash of the uncompressed contents with an 8 byte digest, zero in the old format.
+    // Compressed entries are checked against it when they are decompressed
+    uint64_t content_hash(std::string_view name) const;
+
+    // in directory order, sorted by fnv1a_hash then by name
+    std::vector<std::string_view> names() const;
+
+    int version() const {
+        return m_version;
+    }
+
+private:
+    struct pak_entry {
+        uint64_t name_hash;
+        std::string_view name;
+        resource_view data;
+        size_t size;
+        uint64_t content_hash;
+        uint32_t flags;
+    };
+
+    const pak_entry *find_entry(std::string_view name) const;
+
+    static std::vector<char> decompress_verified(const pak_entry &entry);
+
+    void read_directory_v1(const std::filesystem::path &path);
+    void read_directory_v2(const std::filesystem::path &path);
+
+    mapped_file m_file;
+    int m_version = 1;
+
+    // sorted by name hash, then by name
+    std::vector<pak_entry> m_entries;
+
+    mutable std::mutex m_decompressed_mutex;
+    mutable std::map<std::string_view, std::vector<char>, std::less<>> m_decompressed;
+};
+
+#endif
\ No newline at end of file
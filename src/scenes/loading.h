@@ -14,6 +14,7 @@ public:
     void refresh_layout() override;
 
     void tick(duration_type time_elapsed) override;
+    bool is_animating() const override { return true; }
     void render(sdl::renderer &renderer) override;
 
 private:
@@ -27,6 +27,10 @@ public:
 
     void send_lobby_edited();
 
+    const banggame::game_options &get_lobby_options() const {
+        return m_lobby_options;
+    }
+
 private:
     class lobby_player_item {
     public:
@@ -20,6 +20,12 @@ struct message_handler<E> {
     virtual void handle_message(enums::enum_tag_t<E>, const enums::enum_type_t<E> &args) = 0;
 };
 
+// messages carrying a raw json payload are passed by value so the handler can take ownership of the tree
+template<banggame::server_message_type E> requires enums::value_with_type<E> && std::same_as<enums::enum_type_t<E>, json::json>
+struct message_handler<E> {
+    virtual void handle_message(enums::enum_tag_t<E>, json::json args) = 0;
+};
+
 class scene_base {
 public:
     scene_base(client_manager *parent) : parent(parent) {}
@@ -28,6 +34,9 @@ public:
     virtual void refresh_layout() = 0;
 
     virtual void tick(duration_type time_elapsed) {}
+
+    // while this returns true the scene is redrawn at the full frame rate
+    virtual bool is_animating() const { return false; }
     
     virtual void render(sdl::renderer &renderer) = 0;
     
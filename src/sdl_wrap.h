@@ -7,11 +7,14 @@
 #include <SDL2/SDL2_rotozoom.h>
 
 #include <fmt/format.h>
+#include <algorithm>
 #include <stdexcept>
 #include <memory>
 
 #include "utils/resource.h"
 
+#include "alpha_mask.h"
+
 namespace sdl {
 
     using rect = SDL_Rect;
@@ -328,6 +331,32 @@ namespace sdl {
         }
     };
 
+    // redirects rendering to a target texture until it goes out of scope,
+    // then restores the previous target and clip rect
+    class render_target_guard {
+    private:
+        renderer &m_renderer;
+        SDL_Texture *m_prev_target;
+        rect m_prev_clip{};
+
+    public:
+        render_target_guard(renderer &renderer, texture_ref target)
+            : m_renderer(renderer)
+            , m_prev_target(SDL_GetRenderTarget(renderer.get()))
+        {
+            SDL_RenderGetClipRect(renderer.get(), &m_prev_clip);
+            SDL_SetRenderTarget(renderer.get(), target.get());
+        }
+
+        ~render_target_guard() {
+            SDL_SetRenderTarget(m_renderer.get(), m_prev_target);
+            SDL_RenderSetClipRect(m_renderer.get(), SDL_RectEmpty(&m_prev_clip) ? nullptr : &m_prev_clip);
+        }
+
+        render_target_guard(const render_target_guard &) = delete;
+        render_target_guard &operator = (const render_target_guard &) = delete;
+    };
+
     class auto_texture {
         surface m_surface;
         texture m_texture;
@@ -389,17 +418,27 @@ namespace sdl {
         }
     };
 
-    inline surface make_text_surface(const std::string &label, const font &font, int width, color text_color = rgb(0x0)) {
-        if (label.empty()) {
-            return surface();
-        }
-        SDL_Surface *s = width > 0
-            ? TTF_RenderUTF8_Blended_Wrapped(font.get(), label.c_str(), text_color, width)
-            : TTF_RenderUTF8_Blended(font.get(), label.c_str(), text_color);
-        if (!s) {
-            throw error(fmt::format("Could not render text: {}", TTF_GetError()));
+    // returns the number of copies issued, one per tile
+    inline int render_tiled(renderer &renderer, texture_ref texture, const rect &dst_rect) {
+        const rect src_rect = texture.get_rect();
+        if (src_rect.w <= 0 || src_rect.h <= 0) return 0;
+
+        int count = 0;
+        for (int y=dst_rect.y; y<dst_rect.y + dst_rect.h; y+=src_rect.h) {
+            for (int x=dst_rect.x; x<dst_rect.x + dst_rect.w; x+=src_rect.w) {
+                rect from = src_rect;
+                rect to{x, y, src_rect.w, src_rect.h};
+                if (to.x + to.w > dst_rect.x + dst_rect.w) {
+                    from.w = to.w = dst_rect.x + dst_rect.w - to.x;
+                }
+                if (to.y + to.h > dst_rect.y + dst_rect.h) {
+                    from.h = to.h = dst_rect.y + dst_rect.h - to.y;
+                }
+                SDL_RenderCopy(renderer.get(), texture.get(), &from, &to);
+                ++count;
+            }
         }
-        return s;
+        return count;
     }
 
     inline bool point_in_rect(const point &pt, const rect &rect) {
@@ -417,8 +456,55 @@ namespace sdl {
         rect.h = new_height;
     }
 
+    // size of rect shrunk to the given width keeping the aspect ratio, never enlarged
+    inline rect shrink_rect_to_width(rect rect, int width) {
+        if (rect.w > width) {
+            scale_rect_width(rect, width);
+        }
+        return rect;
+    }
+
+    // area averaging resize with premultiplied alpha, accepts any size. Defined in surface_scale.cpp
+    surface scale_surface(const surface &surf, int width, int height);
+
+    // divides both sides by scale, rounding down like shrinkSurface did but never below 1x1
     inline surface scale_surface(const surface &surf, int scale) {
-        return shrinkSurface(surf.get(), scale, scale);
+        scale = std::max(1, scale);
+        rect rect = surf.get_rect();
+        return scale_surface(surf, std::max(1, rect.w / scale), std::max(1, rect.h / scale));
+    }
+
+    // replaces the alpha channel of dest inside area with the one of mask, both must be 32 bit surfaces
+    inline void copy_alpha_channel(const surface &dest, const surface &mask, rect area) {
+        rect dest_rect = dest.get_rect();
+        rect mask_rect = mask.get_rect();
+        if (!SDL_IntersectRect(&area, &dest_rect, &area) || !SDL_IntersectRect(&area, &mask_rect, &area)) {
+            return;
+        }
+
+        SDL_LockSurface(mask.get());
+        SDL_LockSurface(dest.get());
+
+        const uint32_t alpha = mask.get()->format->Amask;
+
+        for (int y = area.y; y < area.y + area.h; ++y) {
+            uint32_t *dest_ptr = reinterpret_cast<uint32_t *>(static_cast<uint8_t *>(dest.get()->pixels) + y * dest.get()->pitch) + area.x;
+            const uint32_t *mask_ptr = reinterpret_cast<const uint32_t *>(static_cast<const uint8_t *>(mask.get()->pixels) + y * mask.get()->pitch) + area.x;
+            copy_alpha_row(dest_ptr, mask_ptr, size_t(area.w), alpha);
+        }
+
+        SDL_UnlockSurface(dest.get());
+        SDL_UnlockSurface(mask.get());
+    }
+
+    // blits source over a transparent surface of the size of mask, then takes the alpha channel from mask
+    inline surface apply_alpha_mask(const surface &source, const surface &mask) {
+        surface ret(mask.get()->w, mask.get()->h);
+        rect src_rect = source.get_rect();
+        rect dst_rect = ret.get_rect();
+        SDL_BlitSurface(source.get(), &src_rect, ret.get(), &dst_rect);
+        copy_alpha_channel(ret, mask, dst_rect);
+        return ret;
     }
 
 }
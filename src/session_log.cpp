@@ -0,0 +1,134 @@
+#include "session_log.h"
+
+#include <fmt/format.h>
+
+// Each log starts with a magic string, followed by one record per server message:
+// a varint with the microseconds elapsed since the previous record, a varint
+// with the length of the message, then the raw message bytes
+static constexpr std::string_view session_log_magic{"BANGLOG\x01", 8};
+
+using log_duration = std::chrono::microseconds;
+
+static void write_varint(std::ostream &stream, uint64_t value) {
+    while (value >= 0x80) {
+        stream.put(char(0x80 | (value & 0x7f)));
+        value >>= 7;
+    }
+    stream.put(char(value));
+}
+
+static std::optional<uint64_t> read_varint(std::istream &stream) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = stream.get();
+        if (c == std::char_traits<char>::eof()) {
+            return std::nullopt;
+        }
+        value |= uint64_t(c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Invalid varint in session log");
+}
+
+session_recorder::session_recorder(const std::filesystem::path &path)
+    : m_stream(path, std::ios::out | std::ios::binary)
+    , m_start(std::chrono::steady_clock::now())
+{
+    if (m_stream.fail()) {
+        throw std::runtime_error(fmt::format("Could not open {}", path.string()));
+    }
+    m_stream.write(session_log_magic.data(), session_log_magic.size());
+}
+
+void session_recorder::record(std::string_view message) {
+    auto timestamp = std::chrono::duration_cast<log_duration>(std::chrono::steady_clock::now() - m_start);
+    write_varint(m_stream, (timestamp - m_last_timestamp).count());
+    write_varint(m_stream, message.size());
+    m_stream.write(message.data(), message.size());
+    m_last_timestamp = timestamp;
+
+    // the stream buffers the records and is flushed when closed, this only bounds what a crash loses
+    if (timestamp - m_last_flush >= flush_interval) {
+        m_stream.flush();
+        m_last_flush = timestamp;
+    }
+}
+
+session_reader::session_reader(const std::filesystem::path &path)
+    : m_stream(path, std::ios::in | std::ios::binary)
+{
+    if (m_stream.fail()) {
+        throw std::runtime_error(fmt::format("Could not open {}", path.string()));
+    }
+    std::string magic(session_log_magic.size(), '\0');
+    m_stream.read(magic.data(), magic.size());
+    if (magic != session_log_magic) {
+        throw std::runtime_error(fmt::format("{} is not a session log", path.string()));
+    }
+}
+
+std::optional<session_record> session_reader::read_next() {
+    auto delta = read_varint(m_stream);
+    if (!delta) {
+        return std::nullopt;
+    }
+    auto length = read_varint(m_stream);
+    if (!length) {
+        throw std::runtime_error("Truncated session log");
+    }
+
+    m_timestamp += log_duration(*delta);
+
+    session_record ret{m_timestamp, std::string(*length, '\0')};
+    if (!m_stream.read(ret.message.data(), ret.message.size())) {
+        throw std::runtime_error("Truncated session log");
+    }
+    return ret;
+}
+
+std::optional<replay_mode> parse_replay_mode(std::string_view str) {
+    if (str == "original") return replay_mode::original_speed;
+    if (str == "max") return replay_mode::max_speed;
+    if (str == "step") return replay_mode::single_step;
+    return std::nullopt;
+}
+
+session_replayer::session_replayer(const std::filesystem::path &path, replay_mode mode)
+    : m_reader(path)
+    , m_mode(mode)
+    , m_next(m_reader.read_next()) {}
+
+void session_replayer::advance(duration_type time_elapsed) {
+    m_elapsed += time_elapsed;
+}
+
+void session_replayer::step() {
+    ++m_pending_steps;
+}
+
+std::optional<std::string> session_replayer::next_message() {
+    if (!m_next) {
+        return std::nullopt;
+    }
+
+    switch (m_mode) {
+    case replay_mode::original_speed:
+        if (m_next->timestamp > m_elapsed) {
+            return std::nullopt;
+        }
+        break;
+    case replay_mode::single_step:
+        if (m_pending_steps == 0) {
+            return std::nullopt;
+        }
+        --m_pending_steps;
+        break;
+    default:
+        break;
+    }
+
+    auto record = std::exchange(m_next, m_reader.read_next());
+    return std::move(record->message);
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef __SESSION_LOG_H__
+#define __SESSION_LOG_H__
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include "widgets/defaults.h"
+
+struct session_record {
+    duration_type timestamp;
+    std::string message;
+};
+
+class session_recorder {
+public:
+    explicit session_recorder(const std::filesystem::path &path);
+
+    void record(std::string_view message);
+
+private:
+    static constexpr std::chrono::seconds flush_interval{1};
+
+    std::ofstream m_stream;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::microseconds m_last_timestamp{0};
+    std::chrono::microseconds m_last_flush{0};
+};
+
+class session_reader {
+public:
+    explicit session_reader(const std::filesystem::path &path);
+
+    std::optional<session_record> read_next();
+
+private:
+    std::ifstream m_stream;
+    duration_type m_timestamp{0};
+};
+
+enum class replay_mode {
+    original_speed,
+    max_speed,
+    single_step
+};
+
+std::optional<replay_mode> parse_replay_mode(std::string_view str);
+
+class session_replayer {
+public:
+    session_replayer(const std::filesystem::path &path, replay_mode mode);
+
+    void advance(duration_type time_elapsed);
+    void step();
+
+    std::optional<std::string> next_message();
+
+    replay_mode mode() const {
+        return m_mode;
+    }
+
+    bool finished() const {
+        return !m_next;
+    }
+
+private:
+    session_reader m_reader;
+    replay_mode m_mode;
+
+    std::optional<session_record> m_next;
+    duration_type m_elapsed{0};
+    int m_pending_steps = 0;
+};
+
+#endif
\ No newline at end of file
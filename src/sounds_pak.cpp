@@ -1,8 +1,154 @@
 #include "sounds_pak.h"
 
+#include <algorithm>
+#include <cstring>
+
+#ifdef HAVE_VORBISFILE
+    #include <vorbis/vorbisfile.h>
+#endif
+
 namespace sdl {
-    wav_file::wav_file(resource_view res)
-        : base(Mix_LoadWAV_RW(SDL_RWFromConstMem(res.data, int(res.length)), 0)) {
+#ifdef HAVE_VORBISFILE
+    // the Ogg decoder is fed from the mapped pak and its output converted to the mixer format
+    // one block at a time. The whole sound is still decoded before it can play,
+    // but no intermediate copy of the decoded stream is kept next to the final chunk
+    static constexpr size_t ogg_block_size = 16384;
+
+    struct sdl_free_deleter {
+        void operator()(void *ptr) {
+            SDL_free(ptr);
+        }
+    };
+
+    struct ogg_memory_source {
+        resource_view res;
+        size_t pos = 0;
+    };
+
+    static size_t ogg_read(void *ptr, size_t size, size_t count, void *datasource) {
+        auto &source = *static_cast<ogg_memory_source *>(datasource);
+        if (size == 0) return 0;
+        count = std::min(count, (source.res.length - source.pos) / size);
+        std::memcpy(ptr, source.res.data + source.pos, count * size);
+        source.pos += count * size;
+        return count;
+    }
+
+    static int ogg_seek(void *datasource, ogg_int64_t offset, int whence) {
+        auto &source = *static_cast<ogg_memory_source *>(datasource);
+        ogg_int64_t pos = offset;
+        if (whence == SEEK_CUR) {
+            pos += source.pos;
+        } else if (whence == SEEK_END) {
+            pos += source.res.length;
+        }
+        if (pos < 0 || pos > ogg_int64_t(source.res.length)) {
+            return -1;
+        }
+        source.pos = size_t(pos);
+        return 0;
+    }
+
+    static long ogg_tell(void *datasource) {
+        return long(static_cast<ogg_memory_source *>(datasource)->pos);
+    }
+
+    static bool is_ogg_stream(resource_view res) {
+        return res.length >= 4 && std::memcmp(res.data, "OggS", 4) == 0;
+    }
+
+    // returns nullptr if the stream is not Vorbis, as for Opus, which is left to SDL_mixer
+    static Mix_Chunk *load_ogg_stream(resource_view res) {
+        static constexpr ov_callbacks callbacks{ ogg_read, ogg_seek, nullptr, ogg_tell };
+
+        ogg_memory_source source{res};
+        OggVorbis_File file;
+        if (ov_open_callbacks(&source, &file, nullptr, 0, callbacks) != 0) {
+            return nullptr;
+        }
+        std::unique_ptr<OggVorbis_File, decltype(&ov_clear)> file_guard{&file, ov_clear};
+
+        const vorbis_info *info = ov_info(&file, -1);
+
+        int frequency;
+        Uint16 format;
+        int channels;
+        Mix_QuerySpec(&frequency, &format, &channels);
+
+        std::unique_ptr<SDL_AudioStream, decltype(&SDL_FreeAudioStream)> stream{
+            SDL_NewAudioStream(AUDIO_S16SYS, Uint8(info->channels), int(info->rate), format, Uint8(channels), frequency),
+            SDL_FreeAudioStream};
+        if (!stream) {
+            throw error(fmt::format("Error: cannot create audio stream: {}", SDL_GetError()));
+        }
+
+        // the output is sized from the length of the stream, with some room for the resampler
+        const size_t frame_size = SDL_AUDIO_BITSIZE(format) / 8 * channels;
+        const ogg_int64_t num_frames = ov_pcm_total(&file, -1);
+        size_t capacity = num_frames > 0
+            ? (size_t(num_frames * frequency / info->rate) + 64) * frame_size
+            : ogg_block_size;
+
+        std::unique_ptr<Uint8, sdl_free_deleter> buffer{static_cast<Uint8 *>(SDL_malloc(capacity))};
+        if (!buffer) {
+            throw error("Error: out of memory decoding ogg stream");
+        }
+        size_t length = 0;
+
+        auto drain_stream = [&]{
+            while (int available = SDL_AudioStreamAvailable(stream.get())) {
+                if (length + available > capacity) {
+                    capacity = std::max(capacity * 2, length + available);
+                    auto *resized = static_cast<Uint8 *>(SDL_realloc(buffer.get(), capacity));
+                    if (!resized) {
+                        throw error("Error: out of memory decoding ogg stream");
+                    }
+                    buffer.release();
+                    buffer.reset(resized);
+                }
+                int count = SDL_AudioStreamGet(stream.get(), buffer.get() + length, available);
+                if (count <= 0) break;
+                length += count;
+            }
+        };
+
+        char block[ogg_block_size];
+        int bitstream = 0;
+        while (true) {
+            long count = ov_read(&file, block, int(sizeof(block)), SDL_BYTEORDER == SDL_BIG_ENDIAN, 2, 1, &bitstream);
+            if (count == OV_HOLE) continue;
+            if (count < 0) {
+                throw error("Error: cannot decode ogg stream");
+            }
+            if (count == 0) break;
+
+            SDL_AudioStreamPut(stream.get(), block, int(count));
+            drain_stream();
+        }
+        SDL_AudioStreamFlush(stream.get());
+        drain_stream();
+
+        auto *chunk = static_cast<Mix_Chunk *>(SDL_malloc(sizeof(Mix_Chunk)));
+        if (!chunk) {
+            throw error("Error: out of memory decoding ogg stream");
+        }
+        chunk->allocated = 1;
+        chunk->abuf = buffer.release();
+        chunk->alen = Uint32(length);
+        chunk->volume = MIX_MAX_VOLUME;
+        return chunk;
+    }
+#endif
+
+    wav_file::wav_file(resource_view res) {
+#ifdef HAVE_VORBISFILE
+        if (is_ogg_stream(res)) {
+            reset(load_ogg_stream(res));
+        }
+#endif
+        if (!*this) {
+            reset(Mix_LoadWAV_RW(SDL_RWFromConstMem(res.data, int(res.length)), 0));
+        }
         if (!*this) {
             throw error(fmt::format("Error: cannot load wav: {}", Mix_GetError()));
         }
@@ -10,27 +156,86 @@ namespace sdl {
 }
 
 sounds_pak::sounds_pak(const std::filesystem::path &base_path)
-    : sounds_pak_data(ifstream_or_throw(base_path / "sounds.pak"))
-    , sounds_resources(sounds_pak_data)
-{   
-    if (Mix_OpenAudio(MIX_DEFAULT_FREQUENCY, MIX_DEFAULT_FORMAT, MIX_DEFAULT_CHANNELS, 2048) < 0) {
-        throw sdl::error(fmt::format("Error: could not initialize mixer: {}", Mix_GetError()));
+    : sounds_resources(base_path / "sounds.pak")
+    , m_entries(sounds_resources.names().size())
+{
+    auto entry_it = m_entries.begin();
+    for (std::string_view name : sounds_resources.names()) {
+        entry_it->name_hash = fnv1a_hash(name);
+        entry_it->name = name;
+        entry_it->policy = get_sound_policy(name);
+        ++entry_it;
     }
+
+    // Mix_LoadWAV_RW decodes and resamples to the format of the opened device
+    m_loader = std::thread(&sounds_pak::loader_main, this);
 }
 
 sounds_pak::~sounds_pak() {
-    Mix_CloseAudio();
+    m_stopped = true;
+    m_loader.join();
+}
+
+void sounds_pak::loader_main() {
+    auto begin = std::chrono::steady_clock::now();
+    for (sound_entry &entry : m_entries) {
+        if (m_stopped) return;
+        decode_entry(entry);
+    }
+    m_load_time = (std::chrono::steady_clock::now() - begin).count();
+}
+
+void sounds_pak::decode_entry(sound_entry &entry) {
+    std::call_once(entry.decoded, [&]{
+        try {
+            entry.chunk = sdl::wav_file(sounds_resources[entry.name]);
+        } catch (const std::exception &error) {
+            fmt::print(stderr, "{}: {}\n", entry.name, error.what());
+        }
+        entry.ready = true;
+        ++m_num_loaded;
+    });
+}
+
+sounds_pak::sound_entry *sounds_pak::find_entry(std::string_view name) {
+    const uint64_t hash = fnv1a_hash(name);
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), std::tie(hash, name), [](const sound_entry &entry, const auto &key) {
+        return std::tie(entry.name_hash, entry.name) < key;
+    });
+    if (it != m_entries.end() && it->name_hash == hash && it->name == name) {
+        return &*it;
+    }
+    return nullptr;
 }
 
 void sounds_pak::play_sound(std::string_view name, float volume) {
-    if (sounds_resources.contains(name)) {
-        auto it = wav_cache.find(name);
-        if (it == wav_cache.end()) {
-            it = wav_cache.emplace_hint(it, name, sounds_resources[name]);
+    if (sound_entry *entry = find_entry(name)) {
+        auto begin = std::chrono::steady_clock::now();
+
+        // only waits if the loader hasn't got to this sound yet
+        if (!entry->ready) {
+            decode_entry(*entry);
+            ++m_play_stats.num_blocking_plays;
+            m_play_stats.total_blocking_time += std::chrono::steady_clock::now() - begin;
+        }
+
+        if (Mix_Chunk *chunk = entry->chunk.get()) {
+            m_voices.play(chunk, entry->policy, volume);
         }
 
-        Mix_Chunk *chunk = it->second.get();
-        Mix_VolumeChunk(chunk, int(volume * MIX_MAX_VOLUME));
-        Mix_PlayChannel(-1, chunk, 0);
+        if (!entry->played) {
+            entry->played = true;
+            duration_type latency = std::chrono::steady_clock::now() - begin;
+            ++m_play_stats.num_first_plays;
+            m_play_stats.total_first_play_latency += latency;
+            m_play_stats.max_first_play_latency = std::max(m_play_stats.max_first_play_latency, latency);
+        }
     }
+}
+
+sound_stats sounds_pak::get_stats() const {
+    sound_stats ret = m_play_stats;
+    ret.load_time = duration_type{m_load_time.load()};
+    ret.num_loaded = m_num_loaded;
+    return ret;
 }
\ No newline at end of file
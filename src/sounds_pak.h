@@ -1,13 +1,33 @@
 #include <filesystem>
 #include <array>
-#include <map>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <SDL2/SDL_mixer.h>
 #include "sdl_wrap.h"
 
-#include "utils/unpacker.h"
+#include "pak_file.h"
+#include "voice_manager.h"
+#include "widgets/defaults.h"
 
 namespace sdl {
+    struct mixer_initializer {
+        mixer_initializer() {
+            if (Mix_OpenAudio(MIX_DEFAULT_FREQUENCY, MIX_DEFAULT_FORMAT, MIX_DEFAULT_CHANNELS, 2048) < 0) {
+                throw error(fmt::format("Error: could not initialize mixer: {}", Mix_GetError()));
+            }
+        }
+
+        ~mixer_initializer() {
+            Mix_CloseAudio();
+        }
+
+        mixer_initializer(const mixer_initializer &) = delete;
+        mixer_initializer &operator = (const mixer_initializer &) = delete;
+    };
+
     struct chunk_deleter {
         void operator()(Mix_Chunk *chunk) {
             Mix_FreeChunk(chunk);
@@ -18,21 +38,81 @@ namespace sdl {
         using base = std::unique_ptr<Mix_Chunk, chunk_deleter>;
 
     public:
+        wav_file() = default;
         wav_file(resource_view res);
     };
 }
 
+struct sound_stats {
+    // time taken by the background thread to decode every sound, zero until it's done
+    duration_type load_time{0};
+    size_t num_loaded = 0;
+
+    // from the call to play_sound to Mix_PlayChannel, for the first play of each sound
+    size_t num_first_plays = 0;
+    duration_type total_first_play_latency{0};
+    duration_type max_first_play_latency{0};
+
+    // plays that blocked the calling thread because the loader hadn't decoded the sound yet
+    size_t num_blocking_plays = 0;
+    duration_type total_blocking_time{0};
+};
+
 struct sounds_pak {
 public:
     explicit sounds_pak(const std::filesystem::path &base_path);
     ~sounds_pak();
 
+    sounds_pak(const sounds_pak &) = delete;
+    sounds_pak &operator = (const sounds_pak &) = delete;
+
 public:
+    // if the loader hasn't decoded the sound yet, it's decoded on the calling thread
     void play_sound(std::string_view name, float volume = 1.f);
 
+    void update() {
+        m_voices.update();
+    }
+
+    sound_stats get_stats() const;
+
+    const voice_stats &get_voice_stats() const {
+        return m_voices.stats();
+    }
+
 private:
-    std::ifstream sounds_pak_data;
-    const unpacker<std::ifstream> sounds_resources;
+    struct sound_entry {
+        uint64_t name_hash = 0;
+        std::string_view name;
+        sound_policy policy;
+
+        // set by whichever thread decodes the sound first, the other one waits for it
+        std::once_flag decoded;
+        std::atomic<bool> ready = false;
+        sdl::wav_file chunk;
+
+        bool played = false;
+    };
+
+    sound_entry *find_entry(std::string_view name);
+    void decode_entry(sound_entry &entry);
+    void loader_main();
+
+    sdl::mixer_initializer m_mixer;
+
+    const pak_file sounds_resources;
+
+    // in the order of the pak directory, sorted by name hash
+    std::vector<sound_entry> m_entries;
+
+    // halts every channel before the chunks are freed
+    voice_manager m_voices;
+
+    std::atomic<bool> m_stopped = false;
+    std::atomic<size_t> m_num_loaded = 0;
+    std::atomic<duration_type::rep> m_load_time = 0;
+
+    sound_stats m_play_stats;
 
-    std::map<std::string, sdl::wav_file, std::less<>> wav_cache;
+    std::thread m_loader;
 };
\ No newline at end of file
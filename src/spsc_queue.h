@@ -0,0 +1,48 @@
+#ifndef __SPSC_QUEUE_H__
+#define __SPSC_QUEUE_H__
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <optional>
+
+// Bounded lock-free queue with exactly one producer and one consumer thread.
+// The element type must be default constructible, slots are reused after pop
+template<typename T, size_t Size>
+class spsc_queue {
+    static_assert(std::has_single_bit(Size), "Size must be a power of two");
+
+public:
+    // returns false without moving from value if the queue is full
+    bool push(T &&value) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Size) {
+            return false;
+        }
+        m_buffer[head % Size] = std::move(value);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> pop() {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        std::optional<T> ret{std::move(m_buffer[tail % Size])};
+        m_tail.store(tail + 1, std::memory_order_release);
+        return ret;
+    }
+
+    bool empty() const {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, Size> m_buffer;
+
+    alignas(64) std::atomic<size_t> m_head = 0;
+    alignas(64) std::atomic<size_t> m_tail = 0;
+};
+
+#endif
\ No newline at end of file
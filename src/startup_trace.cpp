@@ -0,0 +1,70 @@
+#include "startup_trace.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+#include <fmt/format.h>
+
+static double to_micros(startup_trace::clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void startup_trace::add_span(std::string_view name, clock::time_point begin, clock::time_point end) {
+    std::scoped_lock lock{s_mutex};
+    auto it = std::ranges::find(s_threads, std::this_thread::get_id());
+    if (it == s_threads.end()) {
+        it = s_threads.insert(it, std::this_thread::get_id());
+    }
+    s_spans.push_back(span_record{name, int(it - s_threads.begin()), begin, end});
+}
+
+std::vector<startup_trace::span_record> startup_trace::get_spans() {
+    std::vector<span_record> ret;
+    {
+        std::scoped_lock lock{s_mutex};
+        ret = s_spans;
+    }
+    std::ranges::sort(ret, {}, &span_record::begin);
+    return ret;
+}
+
+startup_trace::clock::time_point startup_trace::start_time() {
+    std::scoped_lock lock{s_mutex};
+    return s_start;
+}
+
+void startup_trace::reset() {
+    std::scoped_lock lock{s_mutex};
+    s_start = clock::now();
+    s_spans.clear();
+    s_threads.clear();
+}
+
+void startup_trace::finish() {
+    const auto spans = get_spans();
+    const auto start = start_time();
+
+    if (const char *path = std::getenv("BANG_STARTUP_TRACE")) {
+        std::ofstream ofs{path};
+        if (ofs.fail()) {
+            fmt::print(stderr, "Could not open {}\n", path);
+        } else {
+            ofs << "{\"traceEvents\":[";
+            for (size_t i = 0; i < spans.size(); ++i) {
+                const span_record &record = spans[i];
+                ofs << fmt::format("{}\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.1f},\"dur\":{:.1f}}}",
+                    i == 0 ? "" : ",", record.name, record.thread_index,
+                    to_micros(record.begin - start), to_micros(record.end - record.begin));
+            }
+            ofs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        }
+    }
+
+    if (std::getenv("BANG_PRINT_STARTUP")) {
+        for (const span_record &record : spans) {
+            fmt::print(stderr, "{:<24} thread {} {:8.2f} ms, ends at {:8.2f} ms\n", record.name, record.thread_index,
+                to_micros(record.end - record.begin) / 1000.0, to_micros(record.end - start) / 1000.0);
+        }
+    }
+}
\ No newline at end of file
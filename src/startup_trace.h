@@ -0,0 +1,69 @@
+#ifndef __STARTUP_TRACE_H__
+#define __STARTUP_TRACE_H__
+
+#include <chrono>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Wall-clock spans of the client startup, from any thread. finish() writes them as Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev) to the file named by BANG_STARTUP_TRACE,
+// and prints them if BANG_PRINT_STARTUP is set
+class startup_trace {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct span_record {
+        std::string_view name;
+        int thread_index;
+        clock::time_point begin;
+        clock::time_point end;
+    };
+
+    class span {
+    public:
+        explicit span(std::string_view name)
+            : m_name(name)
+            , m_begin(clock::now()) {}
+
+        ~span() {
+            end();
+        }
+
+        span(const span &) = delete;
+        span &operator = (const span &) = delete;
+
+        void end() {
+            if (!m_ended) {
+                m_ended = true;
+                add_span(m_name, m_begin, clock::now());
+            }
+        }
+
+    private:
+        std::string_view m_name;
+        clock::time_point m_begin;
+        bool m_ended = false;
+    };
+
+    static void add_span(std::string_view name, clock::time_point begin, clock::time_point end);
+
+    // sorted by begin time
+    static std::vector<span_record> get_spans();
+
+    static clock::time_point start_time();
+
+    // forgets the recorded spans and restarts the clock
+    static void reset();
+
+    static void finish();
+
+private:
+    static inline std::mutex s_mutex;
+    static inline clock::time_point s_start = clock::now();
+    static inline std::vector<span_record> s_spans;
+    static inline std::vector<std::thread::id> s_threads;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "sdl_wrap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace sdl {
+
+    // Source pixels covered by one destination pixel along one axis, with the
+    // fraction of each source pixel that falls inside it. Weights sum up to 1
+    struct scale_taps {
+        std::vector<int> first;
+        std::vector<int> count;
+        std::vector<float> weights;
+        std::vector<size_t> offsets;
+    };
+
+    static scale_taps make_scale_taps(int src_size, int dst_size) {
+        scale_taps ret;
+        ret.first.reserve(dst_size);
+        ret.count.reserve(dst_size);
+        ret.offsets.reserve(dst_size);
+
+        const double scale = double(src_size) / dst_size;
+        for (int d = 0; d < dst_size; ++d) {
+            const double begin = d * scale;
+            const double end = std::min(double(src_size), (d + 1) * scale);
+            const int first = int(begin);
+            const int last = std::min(src_size, int(std::ceil(end)));
+
+            ret.first.push_back(first);
+            ret.count.push_back(last - first);
+            ret.offsets.push_back(ret.weights.size());
+            for (int i = first; i < last; ++i) {
+                ret.weights.push_back(float((std::min(end, i + 1.0) - std::max(begin, double(i))) / scale));
+            }
+        }
+        return ret;
+    }
+
+    struct pixel_accum {
+        float r, g, b, a;
+    };
+
+    surface scale_surface(const surface &source, int width, int height) {
+        surface converted = SDL_ConvertSurfaceFormat(source.get(), SDL_PIXELFORMAT_RGBA32, 0);
+        if (!converted) throw error(fmt::format("Could not convert surface: {}", SDL_GetError()));
+
+        SDL_Surface *src = converted.get();
+        width = std::max(1, width);
+        height = std::max(1, height);
+
+        surface ret(width, height);
+        SDL_Surface *dst = ret.get();
+
+        const scale_taps xtaps = make_scale_taps(src->w, width);
+        const scale_taps ytaps = make_scale_taps(src->h, height);
+
+        // horizontal pass, with the colors premultiplied by alpha so that
+        // transparent pixels don't bleed their color into the average
+        std::vector<pixel_accum> src_row(src->w);
+        std::vector<pixel_accum> columns(size_t(width) * src->h);
+
+        SDL_LockSurface(src);
+        for (int y = 0; y < src->h; ++y) {
+            const uint8_t *src_ptr = static_cast<const uint8_t *>(src->pixels) + y * src->pitch;
+            for (int x = 0; x < src->w; ++x) {
+                const float alpha = src_ptr[x * 4 + 3] * (1.f / 255.f);
+                src_row[x] = {
+                    src_ptr[x * 4 + 0] * alpha,
+                    src_ptr[x * 4 + 1] * alpha,
+                    src_ptr[x * 4 + 2] * alpha,
+                    float(src_ptr[x * 4 + 3])
+                };
+            }
+
+            pixel_accum *out = columns.data() + size_t(y) * width;
+            for (int x = 0; x < width; ++x) {
+                const pixel_accum *in = src_row.data() + xtaps.first[x];
+                const float *weights = xtaps.weights.data() + xtaps.offsets[x];
+                pixel_accum sum{};
+                for (int i = 0; i < xtaps.count[x]; ++i) {
+                    sum.r += in[i].r * weights[i];
+                    sum.g += in[i].g * weights[i];
+                    sum.b += in[i].b * weights[i];
+                    sum.a += in[i].a * weights[i];
+                }
+                out[x] = sum;
+            }
+        }
+        SDL_UnlockSurface(src);
+
+        // vertical pass, accumulating whole rows so that the inner loop runs over contiguous memory
+        std::vector<pixel_accum> dst_row(width);
+
+        SDL_LockSurface(dst);
+        for (int y = 0; y < height; ++y) {
+            std::fill(dst_row.begin(), dst_row.end(), pixel_accum{});
+
+            const float *weights = ytaps.weights.data() + ytaps.offsets[y];
+            for (int i = 0; i < ytaps.count[y]; ++i) {
+                const pixel_accum *in = columns.data() + size_t(ytaps.first[y] + i) * width;
+                const float weight = weights[i];
+                for (int x = 0; x < width; ++x) {
+                    dst_row[x].r += in[x].r * weight;
+                    dst_row[x].g += in[x].g * weight;
+                    dst_row[x].b += in[x].b * weight;
+                    dst_row[x].a += in[x].a * weight;
+                }
+            }
+
+            uint8_t *dst_ptr = static_cast<uint8_t *>(dst->pixels) + y * dst->pitch;
+            for (int x = 0; x < width; ++x) {
+                const pixel_accum &value = dst_row[x];
+                const float unpremultiply = value.a > 0.f ? 255.f / value.a : 0.f;
+                dst_ptr[x * 4 + 0] = uint8_t(std::clamp(value.r * unpremultiply + .5f, 0.f, 255.f));
+                dst_ptr[x * 4 + 1] = uint8_t(std::clamp(value.g * unpremultiply + .5f, 0.f, 255.f));
+                dst_ptr[x * 4 + 2] = uint8_t(std::clamp(value.b * unpremultiply + .5f, 0.f, 255.f));
+                dst_ptr[x * 4 + 3] = uint8_t(std::clamp(value.a + .5f, 0.f, 255.f));
+            }
+        }
+        SDL_UnlockSurface(dst);
+
+        return ret;
+    }
+
+}
\ No newline at end of file
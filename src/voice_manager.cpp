@@ -0,0 +1,164 @@
+#include "voice_manager.h"
+
+#include <algorithm>
+
+struct group_channels {
+    sound_group group;
+    int num_channels;
+};
+
+static constexpr group_channels channel_groups[] = {
+    {sound_group::ui, 2},
+    {sound_group::effects, 6},
+    {sound_group::events, 2},
+};
+
+struct named_sound_policy {
+    std::string_view name;
+    sound_policy policy;
+};
+
+static constexpr named_sound_policy sound_policies[] = {
+    {"draw",            {sound_group::ui, 2}},
+    {"shuffle",         {sound_group::ui, 1}},
+    {"invalid",         {sound_group::ui, 1}},
+
+    {"bang",            {sound_group::effects, 3}},
+    {"gatling",         {sound_group::effects, 2}},
+    {"indians",         {sound_group::effects, 2}},
+    {"bandidos",        {sound_group::effects, 2}},
+    {"duel",            {sound_group::effects, 1}},
+    {"dynamite",        {sound_group::effects, 1}},
+    {"snake",           {sound_group::effects, 1}},
+    {"generalstore",    {sound_group::effects, 1}},
+
+    {"death",           {sound_group::events, 1, true}},
+    {"gamestart",       {sound_group::events, 1, true}},
+};
+
+sound_policy get_sound_policy(std::string_view name) {
+    for (const auto &[policy_name, policy] : sound_policies) {
+        if (policy_name == name) {
+            return policy;
+        }
+    }
+    return {};
+}
+
+voice_manager::voice_manager() {
+    int num_channels = 0;
+    for (const auto &[group, count] : channel_groups) {
+        num_channels += count;
+    }
+    num_channels = Mix_AllocateChannels(num_channels);
+    m_voices.resize(num_channels);
+
+    int first = 0;
+    for (const auto &[group, count] : channel_groups) {
+        Mix_GroupChannels(first, std::min(first + count, num_channels) - 1, int(group));
+        first += count;
+    }
+}
+
+voice_manager::~voice_manager() {
+    Mix_HaltChannel(-1);
+}
+
+bool voice_manager::is_playing(int channel) const {
+    return m_voices[channel].chunk && Mix_Playing(channel);
+}
+
+bool voice_manager::is_ducking() const {
+    for (int channel = 0; channel < int(m_voices.size()); ++channel) {
+        if (m_voices[channel].ducks_others && is_playing(channel)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool voice_manager::is_ducked(const voice &value) const {
+    if (value.ducks_others) return false;
+    for (int channel = 0; channel < int(m_voices.size()); ++channel) {
+        if (m_voices[channel].ducks_others && m_voices[channel].group != value.group && is_playing(channel)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void voice_manager::update_volume(int channel) {
+    const voice &value = m_voices[channel];
+    const float volume = is_ducked(value) ? value.volume * duck_volume : value.volume;
+    Mix_Volume(channel, int(std::clamp(volume, 0.f, 1.f) * MIX_MAX_VOLUME));
+}
+
+int voice_manager::play(Mix_Chunk *chunk, const sound_policy &policy, float volume) {
+    const auto now = clock::now();
+
+    int oldest_same = -1;
+    int num_same = 0;
+    for (int channel = 0; channel < int(m_voices.size()); ++channel) {
+        voice &value = m_voices[channel];
+        if (value.chunk != chunk || !is_playing(channel)) continue;
+
+        if (now - value.start < coalesce_window) {
+            if (volume > value.volume) {
+                value.volume = volume;
+                update_volume(channel);
+            }
+            ++m_stats.coalesced;
+            return channel;
+        }
+
+        ++num_same;
+        if (oldest_same < 0 || value.start < m_voices[oldest_same].start) {
+            oldest_same = channel;
+        }
+    }
+
+    // past the cap the oldest voice of the same sound is restarted, a full group gives up its oldest voice
+    int channel = -1;
+    if (num_same >= policy.max_voices) {
+        channel = oldest_same;
+    } else {
+        channel = Mix_GroupAvailable(int(policy.group));
+        if (channel < 0) {
+            channel = Mix_GroupOldest(int(policy.group));
+        }
+    }
+    if (channel < 0) {
+        return -1;
+    }
+    if (Mix_Playing(channel)) {
+        Mix_HaltChannel(channel);
+        ++m_stats.stolen;
+    }
+
+    m_voices[channel] = voice{chunk, policy.group, policy.ducks_others, volume, now};
+    update_volume(channel);
+    Mix_PlayChannel(channel, chunk, 0);
+    ++m_stats.played;
+
+    if (policy.ducks_others) {
+        m_ducking = true;
+        for (int other = 0; other < int(m_voices.size()); ++other) {
+            if (other != channel && is_playing(other)) {
+                update_volume(other);
+            }
+        }
+    }
+
+    return channel;
+}
+
+void voice_manager::update() {
+    if (m_ducking && !is_ducking()) {
+        m_ducking = false;
+        for (int channel = 0; channel < int(m_voices.size()); ++channel) {
+            if (is_playing(channel)) {
+                update_volume(channel);
+            }
+        }
+    }
+}
\ No newline at end of file
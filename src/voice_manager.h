@@ -0,0 +1,81 @@
+#ifndef __VOICE_MANAGER_H__
+#define __VOICE_MANAGER_H__
+
+#include <SDL2/SDL_mixer.h>
+
+#include <chrono>
+#include <string_view>
+#include <vector>
+
+enum class sound_group {
+    ui,
+    effects,
+    events,
+};
+
+struct sound_policy {
+    sound_group group = sound_group::effects;
+    int max_voices = 2;
+
+    // lowers the volume of the other groups while it plays
+    bool ducks_others = false;
+};
+
+sound_policy get_sound_policy(std::string_view name);
+
+struct voice_stats {
+    size_t played = 0;
+    size_t coalesced = 0;
+    size_t stolen = 0;
+};
+
+// Plays chunks on a fixed set of mixer channels split in one group per sound_group,
+// so that a burst of effects can't take the channels of the other groups
+class voice_manager {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // identical sounds requested within this time are played once
+    static constexpr std::chrono::milliseconds coalesce_window{30};
+
+    static constexpr float duck_volume = .5f;
+
+    // must be constructed after the audio device is opened
+    voice_manager();
+    ~voice_manager();
+
+    voice_manager(const voice_manager &) = delete;
+    voice_manager &operator = (const voice_manager &) = delete;
+
+    // returns the channel playing the chunk, or -1 if the group has no channels
+    int play(Mix_Chunk *chunk, const sound_policy &policy, float volume);
+
+    // restores the volume of the ducked voices once the sounds ducking them are over, called once per frame
+    void update();
+
+    const voice_stats &stats() const {
+        return m_stats;
+    }
+
+private:
+    struct voice {
+        Mix_Chunk *chunk = nullptr;
+        sound_group group{};
+        bool ducks_others = false;
+        float volume = 0.f;
+        clock::time_point start;
+    };
+
+    bool is_playing(int channel) const;
+    bool is_ducking() const;
+    bool is_ducked(const voice &value) const;
+    void update_volume(int channel);
+
+    std::vector<voice> m_voices;
+    voice_stats m_stats;
+
+    // whether a ducking voice was playing at the last update
+    bool m_ducking = false;
+};
+
+#endif
\ No newline at end of file
@@ -9,6 +9,14 @@ button::button(const std::string &label, button_callback_fun &&onclick, const bu
 
 void button::set_label(const std::string &label) {
     m_text.set_value(label);
+    damage::add(m_border_rect);
+}
+
+void button::set_state(button_state state) {
+    if (m_state != state) {
+        m_state = state;
+        damage::add(m_border_rect);
+    }
 }
 
 void button::render(sdl::renderer &renderer) {
@@ -45,18 +53,18 @@ bool button::handle_event(const sdl::event &event) {
     case SDL_MOUSEMOTION:
         if (sdl::point_in_rect(sdl::point{event.motion.x, event.motion.y}, m_border_rect)) {
             if (m_state == state_up) {
-                m_state = state_hover;
+                set_state(state_hover);
             }
         } else {
             if (m_state == state_hover) {
-                m_state = state_up;
+                set_state(state_up);
             }
         }
         break;
     case SDL_MOUSEBUTTONDOWN:
         if (event.button.button == SDL_BUTTON_LEFT
             && sdl::point_in_rect(sdl::point{event.motion.x, event.motion.y}, m_border_rect)) {
-            m_state = state_down;
+            set_state(state_down);
             set_focus(this);
             return true;
         }
@@ -65,13 +73,13 @@ bool button::handle_event(const sdl::event &event) {
         if (event.button.button == SDL_BUTTON_LEFT
             && m_state == state_down) {
             if (sdl::point_in_rect(sdl::point{event.motion.x, event.motion.y}, m_border_rect)) {
-                m_state = state_hover;
+                set_state(state_hover);
                 if (m_onclick) {
                     m_onclick();
                     return true;
                 }
             } else {
-                m_state = state_up;
+                set_state(state_up);
             }
         }
         break;
@@ -20,7 +20,7 @@ namespace widgets {
         button_style m_style;
         stattext m_text;
 
-        sdl::rect m_border_rect;
+        sdl::rect m_border_rect{};
         sdl::point m_text_pos;
 
         button_callback_fun m_onclick;
@@ -30,6 +30,8 @@ namespace widgets {
             state_hover,
             state_down
         } m_state = state_up;
+
+        void set_state(button_state state);
     
     protected:
         bool handle_event(const sdl::event &event) override;
@@ -46,6 +48,7 @@ namespace widgets {
         }
 
         void set_rect(const sdl::rect &rect) {
+            damage::add_moved(m_border_rect, rect);
             m_border_rect = rect;
             
             auto text_rect = m_text.get_rect();
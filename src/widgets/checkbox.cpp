@@ -29,7 +29,15 @@ void checkbox::render(sdl::renderer &renderer) {
     m_text.render(renderer);
 }
 
+void checkbox::set_state(button_state state) {
+    if (m_state != state) {
+        m_state = state;
+        damage::add(m_checkbox_rect);
+    }
+}
+
 void checkbox::set_rect(const sdl::rect &rect) {
+    damage::add_moved(m_border_rect, rect);
     m_border_rect = rect;
     m_checkbox_rect = sdl::rect{rect.x, rect.y, rect.h, rect.h};
 
@@ -44,18 +52,18 @@ bool checkbox::handle_event(const sdl::event &event) {
     case SDL_MOUSEMOTION:
         if (sdl::point_in_rect(sdl::point{event.motion.x, event.motion.y}, m_checkbox_rect)) {
             if (m_state == state_up) {
-                m_state = state_hover;
+                set_state(state_hover);
             }
         } else {
             if (m_state == state_hover) {
-                m_state = state_up;
+                set_state(state_up);
             }
         }
         break;
     case SDL_MOUSEBUTTONDOWN:
         if (event.button.button == SDL_BUTTON_LEFT
             && sdl::point_in_rect(sdl::point{event.motion.x, event.motion.y}, m_checkbox_rect)) {
-            m_state = state_down;
+            set_state(state_down);
             set_focus(this);
             return true;
         }
@@ -64,16 +72,16 @@ bool checkbox::handle_event(const sdl::event &event) {
         if (event.button.button == SDL_BUTTON_LEFT
             && m_state == state_down) {
             if (sdl::point_in_rect(sdl::point{event.motion.x, event.motion.y}, m_checkbox_rect)) {
-                m_state = state_hover;
+                set_state(state_hover);
                 if (!m_locked) {
-                    m_value = !m_value;
+                    set_value(!m_value);
                     if (m_ontoggle) {
                         m_ontoggle(get_value());
                     }
                 }
                 return true;
             } else {
-                m_state = state_up;
+                set_state(state_up);
             }
         }
         break;
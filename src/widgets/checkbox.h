@@ -12,8 +12,8 @@ namespace widgets {
         button_style m_style;
 
         stattext m_text;
-        sdl::rect m_border_rect;
-        sdl::rect m_checkbox_rect;
+        sdl::rect m_border_rect{};
+        sdl::rect m_checkbox_rect{};
         
         bool m_locked = false;
         toggle_callback_fun m_ontoggle;
@@ -26,6 +26,8 @@ namespace widgets {
 
         bool m_value = false;
 
+        void set_state(button_state state);
+
     protected:
         bool handle_event(const sdl::event &event) override;
 
@@ -45,7 +47,10 @@ namespace widgets {
         }
 
         void set_value(bool value) {
-            m_value = value;
+            if (m_value != value) {
+                m_value = value;
+                damage::add(m_checkbox_rect);
+            }
         }
 
         void set_locked(bool value) {
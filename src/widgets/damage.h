@@ -0,0 +1,44 @@
+#ifndef __DAMAGE_H__
+#define __DAMAGE_H__
+
+#include "sdl_wrap.h"
+
+#include <optional>
+
+namespace widgets {
+
+    // Bounding box of the screen areas that widgets changed since the last frame.
+    // client_manager::render clips the next redraw to it, or skips the frame if it's empty
+    class damage {
+    private:
+        static inline std::optional<sdl::rect> s_rect;
+
+    public:
+        static void add(const sdl::rect &rect) {
+            if (rect.w <= 0 || rect.h <= 0) return;
+            if (s_rect) {
+                SDL_UnionRect(&*s_rect, &rect, &*s_rect);
+            } else {
+                s_rect = rect;
+            }
+        }
+
+        static void add_moved(const sdl::rect &old_rect, const sdl::rect &new_rect) {
+            if (!SDL_RectEquals(&old_rect, &new_rect)) {
+                add(old_rect);
+                add(new_rect);
+            }
+        }
+
+        static bool empty() {
+            return !s_rect.has_value();
+        }
+
+        static std::optional<sdl::rect> take() {
+            return std::exchange(s_rect, std::nullopt);
+        }
+    };
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "font_cache.h"
+
+namespace widgets {
+
+    text_engine_ptr font_cache::get(resource_view media_pak::*font, int ptsize) {
+        ++s_lookups;
+        std::erase_if(s_entries, [](const font_entry &entry) { return entry.engine.expired(); });
+
+        for (const font_entry &entry : s_entries) {
+            if (entry.font == font && entry.ptsize == ptsize) {
+                return entry.engine.lock();
+            }
+        }
+
+        auto ret = std::make_shared<text_engine>(media_pak::get().*font, ptsize);
+        s_entries.push_back(font_entry{font, ptsize, ret});
+        ++s_fonts_opened;
+        return ret;
+    }
+
+    font_cache_stats font_cache::get_stats() {
+        font_cache_stats ret{
+            .lookups = s_lookups,
+            .fonts_opened = s_fonts_opened
+        };
+        for (const font_entry &entry : s_entries) {
+            if (auto engine = entry.engine.lock()) {
+                ++ret.fonts_open;
+                ret.atlas_bytes += engine->num_pages() * text_engine::page_size * text_engine::page_size * 4;
+            }
+        }
+        return ret;
+    }
+
+}
\ No newline at end of file
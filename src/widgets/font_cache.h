@@ -0,0 +1,44 @@
+#ifndef __FONT_CACHE_H__
+#define __FONT_CACHE_H__
+
+#include "text_engine.h"
+#include "../media_pak.h"
+
+#include <memory>
+#include <vector>
+
+namespace widgets {
+
+    using text_engine_ptr = std::shared_ptr<text_engine>;
+
+    struct font_cache_stats {
+        size_t lookups = 0;
+        size_t fonts_opened = 0;
+        size_t fonts_open = 0;
+        size_t atlas_bytes = 0;
+    };
+
+    // Every widget with the same font and size shares one text_engine,
+    // which closes the font and frees its atlas when the last of them is destroyed
+    class font_cache {
+    public:
+        static text_engine_ptr get(resource_view media_pak::*font, int ptsize);
+
+        static font_cache_stats get_stats();
+
+    private:
+        // member pointers have no ordering, and there are only a handful of entries
+        struct font_entry {
+            resource_view media_pak::*font;
+            int ptsize;
+            std::weak_ptr<text_engine> engine;
+        };
+
+        static inline std::vector<font_entry> s_entries;
+        static inline size_t s_lookups = 0;
+        static inline size_t s_fonts_opened = 0;
+    };
+
+}
+
+#endif
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include "profile_pic.h"
+#include "damage.h"
 #include "../media_pak.h"
 
 #include <array>
+#include <bit>
 
 namespace widgets {
 
@@ -9,11 +11,13 @@ sdl::surface profile_pic::scale_profile_image(sdl::surface &&image) {
     sdl::rect rect = image.get_rect();
     if (rect.w > rect.h) {
         if (rect.w > size) {
-            return sdl::scale_surface(image, rect.w / size);
+            sdl::scale_rect_width(rect, size);
+            return sdl::scale_surface(image, rect.w, rect.h);
         }
     } else {
         if (rect.h > size) {
-            return sdl::scale_surface(image, rect.h / size);
+            sdl::scale_rect_height(rect, size);
+            return sdl::scale_surface(image, rect.w, rect.h);
         }
     }
     return std::move(image);
@@ -68,12 +72,11 @@ static sdl::texture generate_border_texture(sdl::renderer &renderer, sdl::textur
 
     {
         sdl::texture target = SDL_CreateTexture(renderer.get(), SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, target_rect.w, target_rect.h);
-        SDL_SetRenderTarget(renderer.get(), target.get());
+        sdl::render_target_guard guard{renderer, target};
         renderer.set_draw_color(sdl::rgba(0x0));
         renderer.render_clear();
         source.render(renderer, sdl::move_rect_center(source.get_rect(), sdl::rect_center(target_rect)));
         SDL_RenderReadPixels(renderer.get(), &target_rect, SDL_PIXELFORMAT_RGBA32, source_pixels.get(), target_rect.w * 4);
-        SDL_SetRenderTarget(renderer.get(), nullptr);
     }
 
     sdl::texture ret = SDL_CreateTexture(renderer.get(), SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, target_rect.w, target_rect.h);
@@ -109,6 +112,7 @@ static sdl::texture generate_border_texture(sdl::renderer &renderer, sdl::textur
 
 void profile_pic::set_texture(sdl::texture_ref tex) {
     if (tex) {
+        damage::add(get_damage_rect());
         m_texture = tex;
         m_border_texture.reset();
 
@@ -126,8 +130,23 @@ void profile_pic::set_texture(sdl::texture_ref tex) {
 }
 
 void profile_pic::set_pos(sdl::point pt) {
+    const sdl::rect prev_rect = get_damage_rect();
     m_rect.x = pt.x - m_rect.w / 2;
     m_rect.y = pt.y - m_rect.h / 2;
+    damage::add_moved(prev_rect, get_damage_rect());
+}
+
+void profile_pic::set_border_color(sdl::color color) {
+    if (std::bit_cast<uint32_t>(color) != std::bit_cast<uint32_t>(m_border_color)) {
+        m_border_color = color;
+        damage::add(get_damage_rect());
+    }
+}
+
+sdl::rect profile_pic::get_damage_rect() const {
+    // the border texture is slightly bigger than the image
+    static constexpr int border_size = size + 6;
+    return sdl::move_rect_center(sdl::rect{0, 0, border_size, border_size}, get_pos());
 }
 
 sdl::point profile_pic::get_pos() const {
@@ -41,9 +41,7 @@ namespace widgets {
         void set_pos(sdl::point pt);
         sdl::point get_pos() const;
 
-        void set_border_color(sdl::color color) {
-            m_border_color = color;
-        }
+        void set_border_color(sdl::color color);
         
         void render(sdl::renderer &renderer);
 
@@ -58,12 +56,15 @@ namespace widgets {
     protected:
         bool handle_event(const sdl::event &event) override;
 
+    private:
+        sdl::rect get_damage_rect() const;
+
     private:
         sdl::texture m_owned_texture;
         sdl::texture_ref m_texture;
         sdl::texture m_border_texture;
 
-        sdl::rect m_rect;
+        sdl::rect m_rect{};
 
         sdl::color m_border_color{};
 
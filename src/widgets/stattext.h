@@ -4,6 +4,8 @@
 #include "sdl_wrap.h"
 
 #include "defaults.h"
+#include "damage.h"
+#include "font_cache.h"
 #include "../media_pak.h"
 
 #include <string>
@@ -11,7 +13,7 @@
 namespace widgets {
     struct text_style {
         sdl::color text_color = widgets::default_text_color;
-        resource media_pak::* text_font = &media_pak::font_arial;
+        resource_view media_pak::* text_font = &media_pak::font_arial;
         int text_ptsize = widgets::default_text_ptsize;
         int wrap_length = 0;
         sdl::color bg_color = widgets::default_text_bgcolor;
@@ -22,25 +24,33 @@ namespace widgets {
     class stattext {
     private:
         text_style m_style;
-        sdl::font m_font;
+        text_engine_ptr m_engine;
 
-        sdl::auto_texture m_tex;
+        text_layout m_layout;
 
-        sdl::rect m_rect;
+        sdl::rect m_rect{};
 
         std::string m_value;
 
         int m_wrap_length = 0;
 
         void redraw() {
-            m_tex = make_text_surface(m_value, m_font, m_wrap_length, m_style.text_color);
-            m_rect = m_tex.get_rect();
+            damage::add(get_damage_rect());
+            m_layout = m_engine->layout(m_value, m_wrap_length);
+            m_rect = m_layout.get_rect();
+        }
+
+        sdl::rect get_damage_rect() const {
+            if (m_layout.empty()) return {};
+            return sdl::rect{
+                m_rect.x - m_style.bg_border_x, m_rect.y - m_style.bg_border_y,
+                m_rect.w + m_style.bg_border_x * 2, m_rect.h + m_style.bg_border_y * 2};
         }
 
     public:
         stattext(const text_style &style = {})
             : m_style(style)
-            , m_font(media_pak::get().*(style.text_font), style.text_ptsize)
+            , m_engine(font_cache::get(style.text_font, style.text_ptsize))
             , m_wrap_length(style.wrap_length) {}
 
         stattext(std::string label, const text_style &style = {})
@@ -61,20 +71,20 @@ namespace widgets {
         }
 
         void render(sdl::renderer &renderer) {
-            if (m_tex) {
+            if (!m_layout.empty()) {
                 if (m_style.bg_color.a) {
                     renderer.set_draw_color(m_style.bg_color);
-                    renderer.fill_rect(sdl::rect{
-                        m_rect.x - m_style.bg_border_x, m_rect.y - m_style.bg_border_y,
-                        m_rect.w + m_style.bg_border_x * 2, m_rect.h + m_style.bg_border_y * 2});
+                    renderer.fill_rect(get_damage_rect());
                 }
 
-                m_tex.render(renderer, m_rect);
+                m_engine->render(renderer, m_layout, sdl::point{m_rect.x, m_rect.y}, m_style.text_color);
             }
         }
 
         void set_rect(const sdl::rect &rect) {
+            const sdl::rect prev_rect = get_damage_rect();
             m_rect = rect;
+            damage::add_moved(prev_rect, get_damage_rect());
         }
 
         const sdl::rect &get_rect() const {
@@ -90,12 +100,14 @@ namespace widgets {
         }
 
         void set_point(const sdl::point &pt) {
+            const sdl::rect prev_rect = get_damage_rect();
             m_rect.x = pt.x;
             m_rect.y = pt.y;
+            damage::add_moved(prev_rect, get_damage_rect());
         }
 
         explicit operator bool() const {
-            return bool(m_tex);
+            return !m_layout.empty();
         }
     };
 }
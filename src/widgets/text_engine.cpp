@@ -0,0 +1,281 @@
+#include "text_engine.h"
+
+#include <algorithm>
+
+#ifdef SDL_TTF_VERSION_ATLEAST
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+    #define HAVE_TTF_GLYPH32
+#endif
+#endif
+
+namespace widgets {
+
+    static char32_t decode_utf8(std::string_view str, size_t &pos) {
+        static constexpr char32_t replacement_char = 0xfffd;
+
+        const auto lead = static_cast<unsigned char>(str[pos++]);
+        int length;
+        char32_t ret;
+        if (lead < 0x80) {
+            return lead;
+        } else if ((lead & 0xe0) == 0xc0) {
+            length = 1;
+            ret = lead & 0x1f;
+        } else if ((lead & 0xf0) == 0xe0) {
+            length = 2;
+            ret = lead & 0x0f;
+        } else if ((lead & 0xf8) == 0xf0) {
+            length = 3;
+            ret = lead & 0x07;
+        } else {
+            return replacement_char;
+        }
+        for (; length > 0; --length) {
+            if (pos == str.size() || (static_cast<unsigned char>(str[pos]) & 0xc0) != 0x80) {
+                return replacement_char;
+            }
+            ret = (ret << 6) | (static_cast<unsigned char>(str[pos++]) & 0x3f);
+        }
+        return ret;
+    }
+
+    static bool is_space(char32_t codepoint) {
+        return codepoint == ' ' || codepoint == '\t';
+    }
+
+    text_engine::text_engine(resource_view font_data, int ptsize)
+        : m_font(font_data, ptsize)
+        , m_font_height(TTF_FontHeight(m_font.get()))
+        , m_line_skip(TTF_FontLineSkip(m_font.get())) {}
+
+    glyph_info &text_engine::get_glyph(char32_t codepoint) {
+        auto [it, inserted] = m_glyphs.try_emplace(codepoint);
+        glyph_info &glyph = it->second;
+        if (inserted) {
+            glyph.codepoint = codepoint;
+#ifdef HAVE_TTF_GLYPH32
+            TTF_GlyphMetrics32(m_font.get(), codepoint, nullptr, nullptr, nullptr, nullptr, &glyph.advance);
+#else
+            TTF_GlyphMetrics(m_font.get(), Uint16(codepoint), nullptr, nullptr, nullptr, nullptr, &glyph.advance);
+#endif
+        }
+        return glyph;
+    }
+
+    int text_engine::get_kerning(char32_t prev, char32_t next) const {
+#ifdef HAVE_TTF_GLYPH32
+        return TTF_GetFontKerningSizeGlyphs32(m_font.get(), prev, next);
+#else
+        return TTF_GetFontKerningSizeGlyphs(m_font.get(), Uint16(prev), Uint16(next));
+#endif
+    }
+
+    text_layout text_engine::layout(std::string_view text, int wrap_length) {
+        text_layout ret;
+        auto &glyphs = ret.m_glyphs;
+
+        int x = 0;
+        int y = 0;
+        int num_lines = 1;
+
+        // index of the first glyph of the current line, and of the first one after its last space
+        size_t line_begin = 0;
+        size_t break_index = 0;
+
+        char32_t prev = 0;
+
+        for (size_t pos = 0; pos < text.size();) {
+            const char32_t codepoint = decode_utf8(text, pos);
+            if (codepoint == '\n') {
+                x = 0;
+                y += m_line_skip;
+                ++num_lines;
+                line_begin = break_index = glyphs.size();
+                prev = 0;
+                continue;
+            }
+
+            glyph_info &glyph = get_glyph(codepoint);
+            if (prev) {
+                x += get_kerning(prev, codepoint);
+            }
+
+            if (wrap_length > 0 && !is_space(codepoint) && x + glyph.advance > wrap_length && glyphs.size() > line_begin) {
+                // moves the word being written to the next line, or breaks it if it takes the whole line
+                const size_t first = break_index > line_begin ? break_index : glyphs.size();
+                const int offset = first < glyphs.size() ? glyphs[first].x : x;
+                for (auto it = glyphs.begin() + first; it != glyphs.end(); ++it) {
+                    it->x -= offset;
+                    it->y += m_line_skip;
+                }
+                x -= offset;
+                y += m_line_skip;
+                ++num_lines;
+                line_begin = break_index = first;
+            }
+
+            glyphs.push_back(positioned_glyph{&glyph, x, y});
+            x += glyph.advance;
+            if (is_space(codepoint)) {
+                break_index = glyphs.size();
+            }
+            prev = codepoint;
+        }
+
+        if (!glyphs.empty()) {
+            for (const positioned_glyph &value : glyphs) {
+                if (!is_space(value.glyph->codepoint)) {
+                    ret.m_width = std::max(ret.m_width, value.x + value.glyph->advance);
+                }
+            }
+            ret.m_height = m_font_height + (num_lines - 1) * m_line_skip;
+        }
+        return ret;
+    }
+
+    int text_engine::text_width(std::string_view text) {
+        int x = 0;
+        char32_t prev = 0;
+        for (size_t pos = 0; pos < text.size();) {
+            const char32_t codepoint = decode_utf8(text, pos);
+            if (prev) {
+                x += get_kerning(prev, codepoint);
+            }
+            x += get_glyph(codepoint).advance;
+            prev = codepoint;
+        }
+        return x;
+    }
+
+    int text_engine::fit_count(std::string_view text, int width) {
+        int x = 0;
+        int count = 0;
+        char32_t prev = 0;
+        for (size_t pos = 0; pos < text.size(); ++count) {
+            const char32_t codepoint = decode_utf8(text, pos);
+            if (prev) {
+                x += get_kerning(prev, codepoint);
+            }
+            x += get_glyph(codepoint).advance;
+            if (x > width) {
+                break;
+            }
+            prev = codepoint;
+        }
+        return count;
+    }
+
+    void text_engine::upload_glyph(sdl::renderer &renderer, glyph_info &glyph) {
+        glyph.uploaded = true;
+        if (is_space(glyph.codepoint)) return;
+
+        // rendered in white, the text color is applied when drawing
+#ifdef HAVE_TTF_GLYPH32
+        sdl::surface surf = TTF_RenderGlyph32_Blended(m_font.get(), glyph.codepoint, sdl::rgb(0xffffff));
+#else
+        sdl::surface surf = TTF_RenderGlyph_Blended(m_font.get(), Uint16(glyph.codepoint), sdl::rgb(0xffffff));
+#endif
+        if (surf && surf.get()->format->format != SDL_PIXELFORMAT_ARGB8888) {
+            surf = SDL_ConvertSurfaceFormat(surf.get(), SDL_PIXELFORMAT_ARGB8888, 0);
+        }
+        if (!surf) return;
+
+        const int width = surf.get()->w;
+        const int height = surf.get()->h;
+        if (width <= 0 || height <= 0 || width >= page_size || height >= page_size) return;
+
+        // glyphs are packed in rows as tall as the tallest glyph in them, one pixel apart
+        if (!m_pages.empty()) {
+            atlas_page &page = m_pages.back();
+            if (page.shelf_x + width > page_size) {
+                page.shelf_x = 0;
+                page.shelf_y += page.shelf_height + 1;
+                page.shelf_height = 0;
+            }
+        }
+        if (m_pages.empty() || m_pages.back().shelf_y + height > page_size) {
+            atlas_page &page = m_pages.emplace_back(sdl::texture(SDL_CreateTexture(renderer.get(),
+                SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, page_size, page_size)));
+            SDL_SetTextureBlendMode(page.texture.get(), SDL_BLENDMODE_BLEND);
+        }
+
+        atlas_page &page = m_pages.back();
+        glyph.page = int(m_pages.size() - 1);
+        glyph.src_rect = sdl::rect{page.shelf_x, page.shelf_y, width, height};
+        SDL_UpdateTexture(page.texture.get(), &glyph.src_rect, surf.get()->pixels, surf.get()->pitch);
+
+        page.shelf_x += width + 1;
+        page.shelf_height = std::max(page.shelf_height, height);
+    }
+
+    void text_engine::render(sdl::renderer &renderer, const text_layout &layout, const sdl::point &pt,
+        const sdl::color &color, const sdl::rect *clip_rect)
+    {
+        for (const positioned_glyph &value : layout.m_glyphs) {
+            if (!value.glyph->uploaded) {
+                upload_glyph(renderer, *value.glyph);
+            }
+        }
+
+        for (int page = 0; page < int(m_pages.size()); ++page) {
+            SDL_Texture *texture = m_pages[page].texture.get();
+#if !SDL_VERSION_ATLEAST(2, 0, 18)
+            SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+            SDL_SetTextureAlphaMod(texture, color.a);
+#endif
+            for (const positioned_glyph &value : layout.m_glyphs) {
+                const glyph_info &glyph = *value.glyph;
+                if (glyph.page != page || SDL_RectEmpty(&glyph.src_rect)) continue;
+
+                sdl::rect src_rect = glyph.src_rect;
+                sdl::rect dst_rect{pt.x + value.x, pt.y + value.y, src_rect.w, src_rect.h};
+                if (clip_rect) {
+                    sdl::rect clipped;
+                    if (!SDL_IntersectRect(&dst_rect, clip_rect, &clipped)) continue;
+                    src_rect.x += clipped.x - dst_rect.x;
+                    src_rect.y += clipped.y - dst_rect.y;
+                    src_rect.w = clipped.w;
+                    src_rect.h = clipped.h;
+                    dst_rect = clipped;
+                }
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+                const float u0 = float(src_rect.x) / page_size;
+                const float v0 = float(src_rect.y) / page_size;
+                const float u1 = float(src_rect.x + src_rect.w) / page_size;
+                const float v1 = float(src_rect.y + src_rect.h) / page_size;
+
+                const float x0 = float(dst_rect.x);
+                const float y0 = float(dst_rect.y);
+                const float x1 = float(dst_rect.x + dst_rect.w);
+                const float y1 = float(dst_rect.y + dst_rect.h);
+
+                const int base = int(m_vertices.size());
+                m_vertices.push_back(SDL_Vertex{ SDL_FPoint{ x0, y0 }, color, SDL_FPoint{ u0, v0 } });
+                m_vertices.push_back(SDL_Vertex{ SDL_FPoint{ x1, y0 }, color, SDL_FPoint{ u1, v0 } });
+                m_vertices.push_back(SDL_Vertex{ SDL_FPoint{ x1, y1 }, color, SDL_FPoint{ u1, v1 } });
+                m_vertices.push_back(SDL_Vertex{ SDL_FPoint{ x0, y1 }, color, SDL_FPoint{ u0, v1 } });
+
+                for (int index : {0, 1, 2, 0, 2, 3}) {
+                    m_indices.push_back(base + index);
+                }
+#else
+                SDL_RenderCopy(renderer.get(), texture, &src_rect, &dst_rect);
+#endif
+            }
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            if (!m_indices.empty()) {
+                SDL_RenderGeometry(renderer.get(), texture,
+                    m_vertices.data(), int(m_vertices.size()),
+                    m_indices.data(), int(m_indices.size()));
+                m_vertices.clear();
+                m_indices.clear();
+            }
+#else
+            SDL_SetTextureColorMod(texture, 0xff, 0xff, 0xff);
+            SDL_SetTextureAlphaMod(texture, 0xff);
+#endif
+        }
+    }
+
+}
\ No newline at end of file
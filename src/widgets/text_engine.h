@@ -0,0 +1,101 @@
+#ifndef __TEXT_ENGINE_H__
+#define __TEXT_ENGINE_H__
+
+#include "sdl_wrap.h"
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace widgets {
+
+    struct glyph_info {
+        char32_t codepoint = 0;
+        int advance = 0;
+
+        // the glyph is rendered in the atlas the first time it is drawn.
+        // An empty src_rect means there is nothing to draw, as for spaces
+        bool uploaded = false;
+        int page = 0;
+        sdl::rect src_rect{};
+    };
+
+    struct positioned_glyph {
+        glyph_info *glyph;
+        int x;
+        int y;
+    };
+
+    class text_layout {
+    public:
+        bool empty() const {
+            return m_glyphs.empty();
+        }
+
+        sdl::rect get_rect() const {
+            return sdl::rect{0, 0, m_width, m_height};
+        }
+
+    private:
+        friend class text_engine;
+
+        std::vector<positioned_glyph> m_glyphs;
+        int m_width = 0;
+        int m_height = 0;
+    };
+
+    // Lays out and draws strings from glyphs rendered once by SDL_ttf and kept in atlas pages,
+    // so changing a text only computes positions and drawing it takes a draw call per page
+    class text_engine {
+    public:
+        static constexpr int page_size = 512;
+
+        text_engine(resource_view font_data, int ptsize);
+
+        text_engine(const text_engine &) = delete;
+        text_engine &operator = (const text_engine &) = delete;
+
+        // breaks lines at '\n', and at spaces to fit wrap_length if it's greater than zero
+        text_layout layout(std::string_view text, int wrap_length = 0);
+
+        // width of a single line of text
+        int text_width(std::string_view text);
+
+        // number of characters of a single line of text that fit in width
+        int fit_count(std::string_view text, int width);
+
+        void render(sdl::renderer &renderer, const text_layout &layout, const sdl::point &pt,
+            const sdl::color &color, const sdl::rect *clip_rect = nullptr);
+
+        size_t num_pages() const {
+            return m_pages.size();
+        }
+
+    private:
+        glyph_info &get_glyph(char32_t codepoint);
+        int get_kerning(char32_t prev, char32_t next) const;
+        void upload_glyph(sdl::renderer &renderer, glyph_info &glyph);
+
+        struct atlas_page {
+            sdl::texture texture;
+            int shelf_x = 0;
+            int shelf_y = 0;
+            int shelf_height = 0;
+        };
+
+        sdl::font m_font;
+        int m_font_height;
+        int m_line_skip;
+
+        std::unordered_map<char32_t, glyph_info> m_glyphs;
+        std::vector<atlas_page> m_pages;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        std::vector<SDL_Vertex> m_vertices;
+        std::vector<int> m_indices;
+#endif
+    };
+
+}
+
+#endif
\ No newline at end of file
@@ -4,7 +4,7 @@ using namespace widgets;
 
 textbox::textbox(const textbox_style &style)
     : m_style(style)
-    , m_font(media_pak::get().*(style.text.text_font), style.text.text_ptsize) {}
+    , m_engine(font_cache::get(style.text.text_font, style.text.text_ptsize)) {}
 
 inline bool is_first_utf8_char(char c) {
     return (c & 0xc0) != 0x80;
@@ -61,20 +61,12 @@ static std::string unicode_substring(const std::string &str, int pos, int len) {
     return std::string{begin, end};
 }
 
-static int measure_cursor(const sdl::font &font, const std::string &text, int xdiff) {
-    int extent, count;
-    TTF_MeasureUTF8(font.get(), text.c_str(), xdiff, &extent, &count);
-    return count;
-}
-
-static int get_text_width(const sdl::font &font, const std::string &text) {
-    int x, y;
-    TTF_SizeUTF8(font.get(), text.c_str(), &x, &y);
-    return x;
-}
-
 void textbox::tick(duration_type time_elapsed) {
+    bool was_visible = cursor_visible();
     m_timer += time_elapsed;
+    if (cursor_visible() != was_visible) {
+        damage::add(m_border_rect);
+    }
 }
 
 void textbox::render(sdl::renderer &renderer) {
@@ -93,40 +85,24 @@ void textbox::render(sdl::renderer &renderer) {
 
     int linex = m_crop.x;
 
-    if (m_tex) {
-        linex = get_text_width(m_font, unicode_substring(m_value, 0, m_cursor_pos));
+    if (!m_layout.empty()) {
+        linex = m_engine->text_width(unicode_substring(m_value, 0, m_cursor_pos));
         if (linex < m_hscroll) {
             m_hscroll = linex;
         } else if (linex > m_hscroll + m_crop.w) {
             m_hscroll = linex - m_crop.w;
         }
 
-        sdl::rect src_rect = m_tex.get_rect();
-        sdl::rect dst_rect = src_rect;
-        if (src_rect.w < m_crop.w) {
+        const sdl::rect text_rect = m_layout.get_rect();
+        if (text_rect.w < m_crop.w) {
             m_hscroll = 0;
         }
 
-        dst_rect.x = m_crop.x - m_hscroll;
-        dst_rect.y = m_crop.y;
-
-        linex += dst_rect.x;
-        if (dst_rect.x < m_crop.x) {
-            int diff = m_crop.x - dst_rect.x;
-            src_rect.x += diff;
-            src_rect.w -= diff;
-            dst_rect.x += diff;
-            dst_rect.w -= diff;
-        }
-
-        if (dst_rect.x + dst_rect.w > m_crop.x + m_crop.w) {
-            int diff = dst_rect.x + dst_rect.w - m_crop.x - m_crop.w;
-            src_rect.w -= diff;
-            dst_rect.w -= diff;
-        }
+        const sdl::point text_pos{m_crop.x - m_hscroll, m_crop.y};
+        linex += text_pos.x;
     
         if (focused() && m_cursor_len) {
-            int linew = get_text_width(m_font, unicode_substring(m_value, m_cursor_pos, m_cursor_len));
+            int linew = m_engine->text_width(unicode_substring(m_value, m_cursor_pos, m_cursor_len));
             if (m_cursor_len < 0) {
                 linew = -linew;
             }
@@ -143,10 +119,12 @@ void textbox::render(sdl::renderer &renderer) {
             renderer.fill_rect(sdl::rect{min, m_border_rect.y + 1, max - min, m_border_rect.h - 2});
         }
 
-        SDL_RenderCopy(renderer.get(), m_tex.get_texture(renderer).get(), &src_rect, &dst_rect);
+        // the text is only cut at the sides of the box
+        const sdl::rect clip_rect{m_crop.x, text_pos.y, m_crop.w, text_rect.h};
+        m_engine->render(renderer, m_layout, text_pos, m_style.text.text_color, &clip_rect);
     }
 
-    if (focused() && (m_timer % m_style.cycle_duration) < (m_style.cycle_duration / 2)) {
+    if (cursor_visible()) {
         renderer.set_draw_color(m_style.border_color);
         SDL_RenderDrawLine(renderer.get(), linex, m_crop.y, linex, m_crop.y + m_crop.h);
     }
@@ -154,10 +132,12 @@ void textbox::render(sdl::renderer &renderer) {
 
 void textbox::on_gain_focus() {
     m_timer = duration_type{0};
+    damage::add(m_border_rect);
     SDL_StartTextInput();
 }
 
 void textbox::on_lose_focus() {
+    damage::add(m_border_rect);
     SDL_StopTextInput();
     if (on_losefocus) {
         on_losefocus(get_value());
@@ -172,7 +152,7 @@ bool textbox::handle_event(const sdl::event &event) {
             if (m_value.empty()) {
                 m_cursor_pos = 0;
             } else {
-                m_cursor_pos = measure_cursor(m_font, m_value, event.button.x - (m_border_rect.x + m_style.margin - m_hscroll));
+                m_cursor_pos = m_engine->fit_count(m_value, event.button.x - (m_border_rect.x + m_style.margin - m_hscroll));
             }
             m_cursor_len = 0;
             m_mouse_down = true;
@@ -183,9 +163,10 @@ bool textbox::handle_event(const sdl::event &event) {
     case SDL_MOUSEMOTION:
         if (m_mouse_down && !m_value.empty()) {
             int pos = m_cursor_pos;
-            m_cursor_pos = measure_cursor(m_font, m_value, event.button.x - (m_border_rect.x + m_style.margin - m_hscroll));
+            m_cursor_pos = m_engine->fit_count(m_value, event.button.x - (m_border_rect.x + m_style.margin - m_hscroll));
             m_cursor_len += pos - m_cursor_pos;
             m_timer = duration_type{0};
+            damage::add(m_border_rect);
             return true;
         }
         return false;
@@ -21,10 +21,10 @@ namespace widgets {
     private:
         textbox_style m_style;
 
-        sdl::font m_font;
-        sdl::auto_texture m_tex;
+        text_engine_ptr m_engine;
+        text_layout m_layout;
 
-        sdl::rect m_border_rect;
+        sdl::rect m_border_rect{};
 
         std::string m_value;
 
@@ -40,7 +40,12 @@ namespace widgets {
         bool m_locked = false;
 
         void redraw() {
-            m_tex = make_text_surface(m_value, m_font, 0, m_style.text.text_color);
+            m_layout = m_engine->layout(m_value);
+            damage::add(m_border_rect);
+        }
+
+        bool cursor_visible() const {
+            return focused() && (m_timer % m_style.cycle_duration) < (m_style.cycle_duration / 2);
         }
 
     protected:
@@ -60,6 +65,7 @@ namespace widgets {
         }
 
         void set_rect(const sdl::rect &rect) {
+            damage::add_moved(m_border_rect, rect);
             m_border_rect = rect;
         }
 
@@ -3,6 +3,12 @@
 namespace net {
         
 void wsconnection::connect(const std::string &url) {
+    run_in_context([this, url]{
+        do_connect(url);
+    });
+}
+
+void wsconnection::do_connect(const std::string &url) {
     auto init_client = [&]<typename Config>(std::in_place_type_t<Config>) -> decltype(auto) {
         auto &client = m_client.emplace<client_and_connection<Config>>().client;
         client.init_asio(&m_ctx);
@@ -58,6 +64,12 @@ void wsconnection::connect(const std::string &url) {
 }
 
 void wsconnection::disconnect() {
+    run_in_context([this]{
+        do_disconnect();
+    });
+}
+
+void wsconnection::do_disconnect() {
     std::visit(overloaded{
         [](std::monostate) {},
         []<typename Config>(client_and_connection<Config> &client) {
@@ -75,18 +87,38 @@ void wsconnection::disconnect() {
     }, m_client);
 }
 
+void wsconnection::start_thread() {
+    if (!m_thread.joinable()) {
+        m_thread = std::thread([this]{
+            m_ctx.run();
+        });
+    }
+}
+
+void wsconnection::stop_thread() {
+    if (m_thread.joinable()) {
+        m_ctx.stop();
+        m_thread.join();
+        m_ctx.restart();
+    }
+}
+
 void wsconnection::poll() {
-    m_ctx.poll();
+    if (!is_threaded()) {
+        m_ctx.poll();
+    }
 }
 
-void wsconnection::push_message(const std::string &message) {
-    std::error_code ec;
-    std::visit(overloaded{
-        [](std::monostate) {},
-        [&]<typename Config>(client_and_connection<Config> &client) {
-            client.client.send(client.connection, message, websocketpp::frame::opcode::text, ec);
-        },
-    }, m_client);
+void wsconnection::push_message(std::string message) {
+    run_in_context([this, message = std::move(message)]{
+        std::error_code ec;
+        std::visit(overloaded{
+            [](std::monostate) {},
+            [&]<typename Config>(client_and_connection<Config> &client) {
+                client.client.send(client.connection, message, websocketpp::frame::opcode::text, ec);
+            },
+        }, m_client);
+    });
 }
 
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <websocketpp/config/asio_client.hpp>
 #include <websocketpp/client.hpp>
 
+#include <thread>
 #include <variant>
 #include "utils/utils.h"
 
@@ -31,6 +32,21 @@ namespace net {
             client_and_connection<websocketpp::config::asio_client>,
             client_and_connection<websocketpp::config::asio_tls_client>
         > m_client;
+
+        std::thread m_thread;
+
+        void do_connect(const std::string &url);
+        void do_disconnect();
+
+        // in threaded mode the client can only be accessed from the network thread
+        template<typename Function>
+        void run_in_context(Function &&fun) {
+            if (is_threaded()) {
+                asio::post(m_ctx, std::forward<Function>(fun));
+            } else {
+                fun();
+            }
+        }
     
     protected:
         virtual void on_open() = 0;
@@ -39,7 +55,9 @@ namespace net {
 
     public:
         wsconnection() : m_work_guard(asio::make_work_guard(m_ctx.get_executor())) {}
-        virtual ~wsconnection() = default;
+        virtual ~wsconnection() {
+            stop_thread();
+        }
             
         void connect(const std::string &url);
         
@@ -49,9 +67,22 @@ namespace net {
             return m_ctx.get_executor();
         }
 
+        // runs the io context on a dedicated thread: on_open, on_close and on_message
+        // are then called from that thread instead of inside poll()
+        void start_thread();
+        void stop_thread();
+
+        bool is_threaded() const {
+            return m_thread.joinable();
+        }
+
+        bool stopped() const {
+            return m_ctx.stopped();
+        }
+
         void poll();
 
-        void push_message(const std::string &message);
+        void push_message(std::string message);
     };
 }
 